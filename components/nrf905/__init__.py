@@ -1,8 +1,17 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome import pins
-from esphome.components import fan, spi
-from esphome.const import CONF_ID
+from esphome.components import fan, sensor, spi, time
+from esphome.const import (
+    CONF_CHANNEL,
+    CONF_ID,
+    CONF_TIME_ID,
+    CONF_UPDATE_INTERVAL,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_MILLISECOND,
+    UNIT_PERCENT,
+)
 
 CONF_AM_PIN = "am_pin"
 CONF_CD_PIN = "cd_pin"
@@ -10,26 +19,173 @@ CONF_CE_PIN = "ce_pin"
 CONF_DR_PIN = "dr_pin"
 CONF_PWR_PIN = "pwr_pin"
 CONF_TXEN_PIN = "txen_pin"
+CONF_OCCUPANCY = "occupancy"
+CONF_BUSY = "busy"
+CONF_BURSTS = "bursts"
+CONF_LONGEST_BURST = "longest_burst"
+CONF_RX_DEDUP_WINDOW = "rx_dedup_window"
+CONF_BAND = "band"
+CONF_TX_POWER = "tx_power"
+CONF_RX_POWER = "rx_power"
+CONF_CRC = "crc"
+CONF_RX_ADDRESS = "rx_address"
+CONF_TX_ADDRESS = "tx_address"
+CONF_RX_ADDRESS_WIDTH = "rx_address_width"
+CONF_TX_ADDRESS_WIDTH = "tx_address_width"
+CONF_RX_PAYLOAD_WIDTH = "rx_payload_width"
+CONF_TX_PAYLOAD_WIDTH = "tx_payload_width"
+CONF_XTAL_FREQUENCY = "xtal_frequency"
+CONF_CLOCK_OUT = "clock_out"
 
 DEPENDENCIES = ["spi"]
+AUTO_LOAD = ["sensor"]
 
 nrf905_ns = cg.esphome_ns.namespace("nrf905")
 nRF905Component = nrf905_ns.class_("nRF905", fan.FanState)
 
-CONFIG_SCHEMA = (
+# Register field values, see the nRF905 datasheet section 9.3
+BANDS = {"433MHZ": 0, "868MHZ": 1, "915MHZ": 1}
+TX_POWERS = {-10: 0, -2: 1, 6: 2, 10: 3}
+RX_POWERS = {"NORMAL": 0, "REDUCED": 1}
+CRCS = {"NONE": 0x00, "8BIT": 0x40, "16BIT": 0xC0}
+XTAL_FREQUENCIES = {4000000: 0, 8000000: 1, 12000000: 2, 16000000: 3, 20000000: 4}
+CLOCK_OUTS = {4000000: 0, 2000000: 1, 1000000: 2, 500000: 3}
+
+# Operating ranges per band (MHz)
+BAND_RANGES = {
+    "433MHZ": (430.0, 440.0),
+    "868MHZ": (862.0, 870.0),
+    "915MHZ": (902.0, 928.0),
+}
+
+
+def channel_frequency(channel, band):
+    return (422.4 + channel / 10) * (1 + BANDS[band])
+
+
+OCCUPANCY_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_UPDATE_INTERVAL, default="60s"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=cv.TimePeriod(seconds=1), max=cv.TimePeriod(hours=1)),
+        ),
+        cv.Optional(CONF_TIME_ID): cv.use_id(time.RealTimeClock),
+        cv.Optional(CONF_BUSY): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            icon="mdi:radio-tower",
+            accuracy_decimals=2,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_BURSTS): sensor.sensor_schema(
+            icon="mdi:counter",
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_LONGEST_BURST): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            icon="mdi:timer-outline",
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }
+)
+
+
+def validate_occupancy(config):
+    if CONF_OCCUPANCY in config and CONF_CD_PIN not in config:
+        raise cv.Invalid(f"{CONF_OCCUPANCY} needs {CONF_CD_PIN}")
+    return config
+
+
+def validate_radio(config):
+    band = config[CONF_BAND]
+    low, high = BAND_RANGES[band]
+    frequency = channel_frequency(config[CONF_CHANNEL], band)
+    if not low <= frequency <= high:
+        raise cv.Invalid(
+            f"{CONF_CHANNEL} {config[CONF_CHANNEL]} is {frequency:.1f} MHz, "
+            f"outside the {band} band ({low} - {high} MHz)"
+        )
+    for address, width in (
+        (CONF_RX_ADDRESS, CONF_RX_ADDRESS_WIDTH),
+        (CONF_TX_ADDRESS, CONF_TX_ADDRESS_WIDTH),
+    ):
+        if config[address] >= (1 << (8 * config[width])):
+            raise cv.Invalid(
+                f"{address} does not fit in {config[width]} byte(s) of {width}"
+            )
+    clock_out = config.get(CONF_CLOCK_OUT, 0)
+    if clock_out > config[CONF_XTAL_FREQUENCY]:
+        raise cv.Invalid(f"{CONF_CLOCK_OUT} cannot exceed {CONF_XTAL_FREQUENCY}")
+    return config
+
+
+def config_image(config):
+    channel = config[CONF_CHANNEL]
+    rx_address = config[CONF_RX_ADDRESS]
+    image = [
+        channel & 0xFF,
+        ((channel >> 8) & 0x01)
+        | (BANDS[config[CONF_BAND]] << 1)
+        | (TX_POWERS[config[CONF_TX_POWER]] << 2)
+        | (RX_POWERS[config[CONF_RX_POWER]] << 4),
+        config[CONF_RX_ADDRESS_WIDTH] | (config[CONF_TX_ADDRESS_WIDTH] << 4),
+        config[CONF_RX_PAYLOAD_WIDTH],
+        config[CONF_TX_PAYLOAD_WIDTH],
+        rx_address & 0xFF,
+        (rx_address >> 8) & 0xFF,
+        (rx_address >> 16) & 0xFF,
+        (rx_address >> 24) & 0xFF,
+        CLOCK_OUTS[config.get(CONF_CLOCK_OUT, 500000)]
+        | (0x04 if CONF_CLOCK_OUT in config else 0x00)
+        | (XTAL_FREQUENCIES[config[CONF_XTAL_FREQUENCY]] << 3)
+        | CRCS[config[CONF_CRC]],
+    ]
+    return "{" + ", ".join(f"0x{byte:02X}" for byte in image) + "}"
+
+
+CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(nRF905Component),
-            cv.Optional(CONF_CD_PIN): pins.gpio_input_pin_schema,
-            cv.Required(CONF_CE_PIN): pins.gpio_output_pin_schema,
-            cv.Required(CONF_PWR_PIN): pins.gpio_output_pin_schema,
-            cv.Required(CONF_TXEN_PIN): pins.gpio_output_pin_schema,
-            cv.Optional(CONF_AM_PIN): pins.gpio_input_pin_schema,
-            cv.Optional(CONF_DR_PIN): pins.gpio_input_pin_schema,
+            cv.Optional(CONF_CD_PIN): pins.internal_gpio_input_pin_schema,
+            cv.Required(CONF_CE_PIN): pins.internal_gpio_output_pin_schema,
+            cv.Required(CONF_PWR_PIN): pins.internal_gpio_output_pin_schema,
+            cv.Required(CONF_TXEN_PIN): pins.internal_gpio_output_pin_schema,
+            cv.Optional(CONF_AM_PIN): pins.internal_gpio_input_pin_schema,
+            cv.Optional(CONF_DR_PIN): pins.internal_gpio_input_pin_schema,
+            cv.Optional(CONF_OCCUPANCY): OCCUPANCY_SCHEMA,
+            cv.Optional(
+                CONF_RX_DEDUP_WINDOW, default="250ms"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_CHANNEL, default=118): cv.int_range(min=0, max=511),
+            cv.Optional(CONF_BAND, default="868MHZ"): cv.one_of(*BANDS, upper=True),
+            cv.Optional(CONF_TX_POWER, default=10): cv.one_of(*TX_POWERS, int=True),
+            cv.Optional(CONF_RX_POWER, default="normal"): cv.enum(
+                RX_POWERS, upper=True
+            ),
+            cv.Optional(CONF_CRC, default="16bit"): cv.enum(CRCS, upper=True),
+            cv.Optional(CONF_RX_ADDRESS, default=0x89816EA9): cv.hex_uint32_t,
+            cv.Optional(CONF_TX_ADDRESS, default=0x89816EA9): cv.hex_uint32_t,
+            cv.Optional(CONF_RX_ADDRESS_WIDTH, default=4): cv.one_of(1, 4, int=True),
+            cv.Optional(CONF_TX_ADDRESS_WIDTH, default=4): cv.one_of(1, 4, int=True),
+            cv.Optional(CONF_RX_PAYLOAD_WIDTH, default=16): cv.int_range(min=1, max=32),
+            cv.Optional(CONF_TX_PAYLOAD_WIDTH, default=16): cv.int_range(min=1, max=32),
+            cv.Optional(CONF_XTAL_FREQUENCY, default="16MHz"): cv.All(
+                cv.frequency, cv.one_of(*XTAL_FREQUENCIES, float=True)
+            ),
+            cv.Optional(CONF_CLOCK_OUT): cv.All(
+                cv.frequency, cv.one_of(*CLOCK_OUTS, float=True)
+            ),
         }
     )
     .extend(cv.COMPONENT_SCHEMA)
-    .extend(spi.spi_device_schema(cs_pin_required=True))
+    .extend(spi.spi_device_schema(cs_pin_required=True)),
+    validate_occupancy,
+    validate_radio,
 )
 
 
@@ -38,6 +194,12 @@ async def to_code(config):
     await cg.register_component(var, config)
     await spi.register_spi_device(var, config)
 
+    # Radio registers are fixed at build time; setup writes this image as is
+    cg.add_define("NRF905_CONFIG_IMAGE", cg.RawExpression(config_image(config)))
+    cg.add_define(
+        "NRF905_TX_ADDRESS", cg.RawExpression(f"0x{config[CONF_TX_ADDRESS]:08X}")
+    )
+
     if CONF_AM_PIN in config:
         data = await cg.gpio_pin_expression(config[CONF_AM_PIN])
         cg.add(var.set_am_pin(data))
@@ -53,3 +215,22 @@ async def to_code(config):
     cg.add(var.set_pwr_pin(data))
     data = await cg.gpio_pin_expression(config[CONF_TXEN_PIN])
     cg.add(var.set_txen_pin(data))
+
+    cg.add(var.set_rx_dedup_window(config[CONF_RX_DEDUP_WINDOW]))
+
+    if CONF_OCCUPANCY in config:
+        occupancy = config[CONF_OCCUPANCY]
+        cg.add(var.set_occupancy(True))
+        cg.add(var.set_occupancy_interval(occupancy[CONF_UPDATE_INTERVAL]))
+        if CONF_TIME_ID in occupancy:
+            rtc = await cg.get_variable(occupancy[CONF_TIME_ID])
+            cg.add(var.set_time(rtc))
+        if CONF_BUSY in occupancy:
+            sens = await sensor.new_sensor(occupancy[CONF_BUSY])
+            cg.add(var.set_busy_sensor(sens))
+        if CONF_BURSTS in occupancy:
+            sens = await sensor.new_sensor(occupancy[CONF_BURSTS])
+            cg.add(var.set_bursts_sensor(sens))
+        if CONF_LONGEST_BURST in occupancy:
+            sens = await sensor.new_sensor(occupancy[CONF_LONGEST_BURST])
+            cg.add(var.set_longest_burst_sensor(sens))
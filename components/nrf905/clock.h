@@ -0,0 +1,35 @@
+#ifndef __COMPONENT_nRF905_CLOCK_H__
+#define __COMPONENT_nRF905_CLOCK_H__
+
+#include <stdint.h>
+
+namespace esphome {
+namespace nrf905 {
+
+/* Time source used by the radio driver and the protocol layer. On target this is the ESPHome clock (see
+ * SystemClock in nRF905.h); on the host a VirtualClock lets long runs, including the 49.7 day millis() wraparound,
+ * pass in seconds. This header has no ESPHome dependencies so host tools can include it. */
+class Clock {
+ public:
+  virtual uint32_t millis(void) = 0;
+  virtual void delay(const uint32_t ms) = 0;
+};
+
+class VirtualClock : public Clock {
+ public:
+  explicit VirtualClock(const uint32_t start = 0) : now_(start) {}
+
+  uint32_t millis(void) override { return this->now_; }
+  void delay(const uint32_t ms) override { this->advance(ms); }
+
+  void advance(const uint32_t ms) { this->now_ += ms; }  // Wraps like millis()
+  void set(const uint32_t ms) { this->now_ = ms; }
+
+ protected:
+  uint32_t now_;
+};
+
+}  // namespace nrf905
+}  // namespace esphome
+
+#endif /* __COMPONENT_nRF905_CLOCK_H__ */
@@ -0,0 +1,80 @@
+#ifndef __COMPONENT_nRF905_DEDUP_H__
+#define __COMPONENT_nRF905_DEDUP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace esphome {
+namespace nrf905 {
+
+#define RX_DEDUP_ENTRIES 4  // Distinct frames remembered
+
+/* Recognises repeats of a received frame. Senders transmit every frame several times; only the first copy within
+ * the window should be handled. Frames are compared by a 32 bit FNV-1a hash, so a different frame is taken for a
+ * repeat only on a hash collision inside the window. By default every repeat restarts the window; without refresh
+ * the window runs from the first copy, so a sender's retry after the window counts as a new frame. */
+class RxDedup {
+ public:
+  void set_window(const uint32_t ms) { window_ = ms; }
+  void set_refresh(const bool refresh) { refresh_ = refresh; }
+  uint32_t getWindow(void) const { return this->window_; }
+  uint32_t getDuplicates(void) const { return this->duplicates_; }
+
+  // True when the frame is a repeat; remembers it otherwise
+  bool isDuplicate(const uint8_t *const pData, const size_t length, const uint32_t now) {
+    const uint32_t hash = RxDedup::hash(pData, length);
+    Entry *pOldest = &this->entries_[0];
+    uint8_t i;
+
+    if (this->window_ == 0) {
+      return false;
+    }
+
+    for (i = 0; i < RX_DEDUP_ENTRIES; ++i) {
+      Entry *const pEntry = &this->entries_[i];
+
+      if ((pEntry->used == true) && (pEntry->hash == hash) && ((now - pEntry->time) < this->window_)) {
+        if (this->refresh_ == true) {
+          pEntry->time = now;  // A burst of repeats stays suppressed until it ends
+        }
+        ++this->duplicates_;
+        return true;
+      }
+      if ((pEntry->used == false) || ((now - pEntry->time) > (now - pOldest->time))) {
+        pOldest = pEntry;
+      }
+    }
+
+    pOldest->used = true;
+    pOldest->hash = hash;
+    pOldest->time = now;
+    return false;
+  }
+
+  static uint32_t hash(const uint8_t *const pData, const size_t length) {
+    uint32_t hash = 2166136261UL;
+    size_t i;
+
+    for (i = 0; i < length; ++i) {
+      hash = (hash ^ pData[i]) * 16777619UL;
+    }
+    return hash;
+  }
+
+ protected:
+  typedef struct {
+    uint32_t hash;
+    uint32_t time;  // Last time the frame was received, or the first time without refresh (ms)
+    bool used;
+  } Entry;
+
+  Entry entries_[RX_DEDUP_ENTRIES]{};
+  uint32_t window_{0};
+  bool refresh_{true};
+  uint32_t duplicates_{0};
+};
+
+}  // namespace nrf905
+}  // namespace esphome
+
+#endif /* __COMPONENT_nRF905_DEDUP_H__ */
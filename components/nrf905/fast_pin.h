@@ -0,0 +1,81 @@
+#ifndef __COMPONENT_nRF905_FAST_PIN_H__
+#define __COMPONENT_nRF905_FAST_PIN_H__
+
+#include "esphome/core/hal.h"
+
+#ifdef USE_ESP32
+#include <sdkconfig.h>
+#ifdef CONFIG_IDF_TARGET_ESP32
+#include <soc/gpio_struct.h>
+#define NRF905_FAST_GPIO  // Set/clear registers of the classic ESP32
+#endif
+#endif
+
+namespace esphome {
+namespace nrf905 {
+
+/* Output pin that remembers its level. A write that does not change the level is skipped; a real change goes
+ * straight to the GPIO set/clear registers on ESP32, or through the GPIOPin otherwise. */
+class FastPin {
+ public:
+  void attach(InternalGPIOPin *const pPin) {
+    this->pin_ = pPin;
+    this->known_ = false;
+#ifdef NRF905_FAST_GPIO
+    this->mask_ = 1UL << (pPin->get_pin() % 32);
+    this->high_ = pPin->get_pin() >= 32;
+    this->inverted_ = pPin->is_inverted();
+#endif
+  }
+
+  void write(const bool level) {
+    if ((this->known_ == true) && (level == this->level_)) {
+      ++this->elided_;
+      return;
+    }
+    this->level_ = level;
+    this->known_ = true;
+    ++this->writes_;
+
+#ifdef NRF905_FAST_GPIO
+    const bool high = level != this->inverted_;
+
+    if (high == true) {
+      if (this->high_ == true) {
+        GPIO.out1_w1ts.val = this->mask_;
+      } else {
+        GPIO.out_w1ts = this->mask_;
+      }
+    } else {
+      if (this->high_ == true) {
+        GPIO.out1_w1tc.val = this->mask_;
+      } else {
+        GPIO.out_w1tc = this->mask_;
+      }
+    }
+#else
+    this->pin_->digital_write(level);
+#endif
+  }
+
+  bool level(void) const { return this->level_; }
+  uint32_t getWrites(void) const { return this->writes_; }
+  uint32_t getElided(void) const { return this->elided_; }
+
+ protected:
+  InternalGPIOPin *pin_{NULL};
+  bool level_{false};
+  bool known_{false};  // Level is unknown until the first write
+  uint32_t writes_{0};
+  uint32_t elided_{0};
+#ifdef NRF905_FAST_GPIO
+  uint32_t mask_{0};
+  bool high_{false};  // GPIO32 and up
+  bool inverted_{false};
+#endif
+};
+
+}  // namespace nrf905
+}  // namespace esphome
+
+#endif /* __COMPONENT_nRF905_FAST_PIN_H__ */
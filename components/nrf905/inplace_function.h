@@ -0,0 +1,90 @@
+#ifndef __COMPONENT_nRF905_INPLACE_FUNCTION_H__
+#define __COMPONENT_nRF905_INPLACE_FUNCTION_H__
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace esphome {
+namespace nrf905 {
+
+/* Move-only replacement for std::function that stores the callable inside the object, so assigning a callback never
+ * touches the heap. Callables that do not fit in Capacity bytes are rejected at compile time. */
+template<typename Signature, size_t Capacity = 2 * sizeof(void *)> class InplaceFunction;
+
+template<typename R, typename... Args, size_t Capacity> class InplaceFunction<R(Args...), Capacity> {
+ public:
+  InplaceFunction() = default;
+  InplaceFunction(std::nullptr_t) {}
+
+  template<typename F, typename Fn = typename std::decay<F>::type,
+           typename = typename std::enable_if<!std::is_same<Fn, InplaceFunction>::value>::type>
+  InplaceFunction(F &&f) {
+    static_assert(sizeof(Fn) <= Capacity, "Callable captures too much; reduce captures or raise Capacity");
+    static_assert(alignof(Fn) <= alignof(Storage), "Callable alignment not supported");
+
+    new (&this->storage_) Fn(std::forward<F>(f));
+    this->invoke_ = [](void *pStorage, Args... args) -> R {
+      return (*static_cast<Fn *>(pStorage))(std::forward<Args>(args)...);
+    };
+    this->manage_ = [](void *pDest, void *pSrc) {
+      if (pDest != nullptr) {
+        new (pDest) Fn(std::move(*static_cast<Fn *>(pSrc)));
+      }
+      static_cast<Fn *>(pSrc)->~Fn();
+    };
+  }
+
+  InplaceFunction(InplaceFunction &&other) { this->moveFrom(other); }
+  InplaceFunction &operator=(InplaceFunction &&other) {
+    if (this != &other) {
+      this->reset();
+      this->moveFrom(other);
+    }
+    return *this;
+  }
+  InplaceFunction &operator=(std::nullptr_t) {
+    this->reset();
+    return *this;
+  }
+
+  InplaceFunction(const InplaceFunction &) = delete;
+  InplaceFunction &operator=(const InplaceFunction &) = delete;
+
+  ~InplaceFunction() { this->reset(); }
+
+  explicit operator bool() const { return this->invoke_ != nullptr; }
+
+  R operator()(Args... args) { return this->invoke_(&this->storage_, std::forward<Args>(args)...); }
+
+ protected:
+  typedef typename std::aligned_storage<Capacity, alignof(void *)>::type Storage;
+
+  void reset(void) {
+    if (this->manage_ != nullptr) {
+      this->manage_(nullptr, &this->storage_);
+    }
+    this->invoke_ = nullptr;
+    this->manage_ = nullptr;
+  }
+
+  void moveFrom(InplaceFunction &other) {
+    if (other.manage_ != nullptr) {
+      other.manage_(&this->storage_, &other.storage_);
+    }
+    this->invoke_ = other.invoke_;
+    this->manage_ = other.manage_;
+    other.invoke_ = nullptr;
+    other.manage_ = nullptr;
+  }
+
+  Storage storage_;
+  R (*invoke_)(void *pStorage, Args... args){nullptr};
+  void (*manage_)(void *pDest, void *pSrc){nullptr};
+};
+
+}  // namespace nrf905
+}  // namespace esphome
+
+#endif /* __COMPONENT_nRF905_INPLACE_FUNCTION_H__ */
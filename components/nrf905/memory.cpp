@@ -0,0 +1,38 @@
+#include "memory.h"
+
+#ifdef USE_ESP32
+#include <esp_heap_caps.h>
+#endif
+
+namespace esphome {
+namespace nrf905 {
+
+MemoryMeter memoryMeter;
+
+void MemoryMeter::heapBegin(void) {
+#ifdef USE_ESP32
+  if (this->radioTask_ == true) {
+    return;
+  }
+  this->heapFree_ = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#endif
+}
+
+void MemoryMeter::heapEnd(void) {
+#ifdef USE_ESP32
+  uint32_t heapFree;
+
+  if (this->radioTask_ == true) {
+    return;
+  }
+
+  heapFree = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  if (heapFree < this->heapFree_) {
+    ++this->heapDrops_;
+    this->heapDropBytes_ += this->heapFree_ - heapFree;
+  }
+#endif
+}
+
+}  // namespace nrf905
+}  // namespace esphome
@@ -0,0 +1,70 @@
+#ifndef __COMPONENT_nRF905_MEMORY_H__
+#define __COMPONENT_nRF905_MEMORY_H__
+
+#include <stdint.h>
+
+namespace esphome {
+namespace nrf905 {
+
+/* Runtime RAM accounting for the nrf905 and zehnder components.
+ *
+ * Stack: MEMORY_STACK_BEGIN() marks the stack depth at a component entry point (loop); MEMORY_STACK_SAMPLE() in
+ * deeper functions records how far below that mark the stack went.
+ * Heap: the free heap is compared before and after the component loops. On ESP32 other tasks run concurrently, so a
+ * drop is a hint to look closer, not proof of an allocation in this code.
+ *
+ * All entry points run on one thread: the main loop, or the radio task when it is enabled. setRadioTask() switches
+ * the meter over; the stack peak then belongs to the radio task stack, and the heap is no longer compared, since the
+ * main loop allocates concurrently with every radio step. */
+class MemoryMeter {
+ public:
+  void stackBegin(const uintptr_t marker) { this->stackTop_ = marker; }
+  void stackSample(const uintptr_t marker) {
+    if ((this->stackTop_ != 0) && (marker < this->stackTop_) && ((this->stackTop_ - marker) > this->stackPeak_)) {
+      this->stackPeak_ = this->stackTop_ - marker;
+    }
+  }
+  void stackEnd(void) { this->stackTop_ = 0; }
+
+  void setRadioTask(const bool radioTask) {
+    this->radioTask_ = radioTask;
+    this->stackPeak_ = 0;
+  }
+  bool isRadioTask(void) const { return this->radioTask_; }
+
+  void heapBegin(void);
+  void heapEnd(void);
+
+  uint32_t getStackPeak(void) const { return this->stackPeak_; }
+  uint32_t getHeapDrops(void) const { return this->heapDrops_; }
+  uint32_t getHeapDropBytes(void) const { return this->heapDropBytes_; }
+
+ protected:
+  uintptr_t stackTop_{0};
+  uint32_t stackPeak_{0};
+
+  uint32_t heapFree_{0};
+  uint32_t heapDrops_{0};
+  uint32_t heapDropBytes_{0};
+
+  bool radioTask_{false};
+};
+
+extern MemoryMeter memoryMeter;
+
+#define MEMORY_STACK_BEGIN() \
+  do { \
+    uint8_t marker_; \
+    esphome::nrf905::memoryMeter.stackBegin((uintptr_t) &marker_); \
+  } while (0)
+
+#define MEMORY_STACK_SAMPLE() \
+  do { \
+    uint8_t marker_; \
+    esphome::nrf905::memoryMeter.stackSample((uintptr_t) &marker_); \
+  } while (0)
+
+}  // namespace nrf905
+}  // namespace esphome
+
+#endif /* __COMPONENT_nRF905_MEMORY_H__ */
@@ -1,5 +1,6 @@
 #include "nRF905.h"
 #include "esphome/core/log.h"
+#include "radio_log.h"
 
 #include <string.h>
 
@@ -10,10 +11,31 @@ namespace nrf905 {
 
 static const char *TAG = "nRF905";
 
+// Register image and TX address are generated from the YAML radio options; these are the defaults
+#ifndef NRF905_CONFIG_IMAGE
+#define NRF905_CONFIG_IMAGE {0x76, 0x0E, 0x44, 0x10, 0x10, 0xA9, 0x6E, 0x81, 0x89, 0xDB}
+#endif
+#ifndef NRF905_TX_ADDRESS
+#define NRF905_TX_ADDRESS 0x89816EA9
+#endif
+
+static constexpr uint8_t configImage[NRF905_REGISTER_COUNT] = NRF905_CONFIG_IMAGE;
+
+static_assert((configImage[1] & 0xC0) == 0, "Reserved bits set in config byte 1");
+static_assert(((configImage[2] & 0x07) == 1) || ((configImage[2] & 0x07) == 4), "RX address width must be 1 or 4");
+static_assert((((configImage[2] >> 4) & 0x07) == 1) || (((configImage[2] >> 4) & 0x07) == 4),
+              "TX address width must be 1 or 4");
+static_assert((configImage[2] & 0x88) == 0, "Reserved bits set in config byte 2");
+static_assert((configImage[3] >= 1) && (configImage[3] <= NRF905_MAX_FRAMESIZE), "RX payload width must be 1-32");
+static_assert((configImage[4] >= 1) && (configImage[4] <= NRF905_MAX_FRAMESIZE), "TX payload width must be 1-32");
+static_assert(((configImage[9] >> 3) & 0x07) <= 4, "Crystal frequency must be 4, 8, 12, 16 or 20 MHz");
+
+SystemClock systemClock;
+
 nRF905::nRF905(void) {}
 
 void nRF905::setup() {
-  Config config;
+  ConfigBuffer buffer;
 
   ESP_LOGD(TAG, "Start nRF905 init");
 
@@ -25,43 +47,52 @@ void nRF905::setup() {
     this->_gpio_pin_cd->setup();
   }
   this->_gpio_pin_ce->setup();
+  this->_pinCe.attach(this->_gpio_pin_ce);
   if (this->_gpio_pin_dr != NULL) {
     this->_gpio_pin_dr->setup();
   }
   this->_gpio_pin_pwr->setup();
+  this->_pinPwr.attach(this->_gpio_pin_pwr);
   this->_gpio_pin_txen->setup();
+  this->_pinTxen.attach(this->_gpio_pin_txen);
 
-  this->setMode(PowerDown);
-
-  this->readConfigRegisters();
-
-  this->_config.band = true;
-  this->_config.channel = 118;
-
-  // CRC 16
-  this->_config.crc_enable = true;
-  this->_config.crc_bits = 16;
-
-  // TX power 10
-  this->_config.tx_power = 10;
-
-  // RX power normal
-  this->_config.rx_power = PowerNormal;
-
-  this->_config.rx_address = 0x89816EA9;  // ZEHNDER_NETWORK_LINK_ID;
-  this->_config.rx_address_width = 4;
-  this->_config.rx_payload_width = 16;
+  if ((this->_occupancyEnabled == true) && (this->_gpio_pin_cd != NULL)) {
+    this->_cdIsrPin = this->_gpio_pin_cd->to_isr();
+    this->_gpio_pin_cd->attach_interrupt(nRF905::cdInterrupt, this, gpio::INTERRUPT_ANY_EDGE);
+  }
+  if (this->_occupancyEnabled == true) {
+    this->set_interval("occupancy", OCCUPANCY_PUBLISH_INTERVAL, [this](void) {
+      // Windows close on time, also when no edge wakes process(); in the radio task, process() closes them
+      if (this->_runInTask == false) {
+        this->occupancyProcess();
+      }
+      this->occupancyPublish();
+    });
+  }
 
-  this->_config.tx_address_width = 4;
-  this->_config.tx_payload_width = 16;
+  // Main loop polling: DR rises when a frame is received or sent, AM on both edges of an address match. Without the
+  // DR pin there is no edge to wait for, and the status register is polled.
+  if (this->_gpio_pin_dr != NULL) {
+    this->_gpio_pin_dr->attach_interrupt(nRF905::stateInterrupt, this, gpio::INTERRUPT_RISING_EDGE);
+    if (this->_gpio_pin_am != NULL) {
+      this->_gpio_pin_am->attach_interrupt(nRF905::stateInterrupt, this, gpio::INTERRUPT_ANY_EDGE);
+    }
+  } else {
+    this->set_interval("status", STATUS_POLL_INTERVAL, [this](void) {
+      if (this->_runInTask == false) {
+        this->process();
+      }
+    });
+  }
 
-  this->_config.xtal_frequency = 16000000;  // defaults for now
-  this->_config.clkOutFrequency = ClkOut500000;
-  this->_config.clkOutEnable = false;
+  this->setMode(PowerDown);
 
-  // Write config back
-  this->writeConfigRegisters();
-  this->writeTxAddress(0x89816EA9);
+  // One write of the register image generated from the YAML configuration
+  (void) memcpy(buffer.data, configImage, NRF905_REGISTER_COUNT);
+  this->decodeConfigRegisters(&buffer, &this->_config);
+  this->printConfig(&this->_config);
+  this->writeConfigBuffer(&buffer);
+  this->writeTxAddress(NRF905_TX_ADDRESS);
 
   // Return to idle
   this->setMode(Idle);
@@ -70,14 +101,21 @@ void nRF905::setup() {
 }
 
 void nRF905::dump_config() {
+  uint32_t modeTimes[NRF905_MODE_COUNT];
+
   ESP_LOGCONFIG(TAG, "Config:");
 
+  ESP_LOGCONFIG(TAG, "  Radio            channel %u, %.1f MHz, %d dBm, CRC %s", this->_config.channel,
+                this->_config.frequency / 1000000.0f, this->_config.tx_power,
+                this->_config.crc_enable ? (this->_config.crc_bits == 16 ? "16" : "8") : "off");
   LOG_PIN("  CS Pin:", this->cs_);
   if (this->_gpio_pin_am != NULL) {
     LOG_PIN("  AM Pin:", this->_gpio_pin_am);
   }
   if (this->_gpio_pin_dr != NULL) {
     LOG_PIN("  DR Pin:", this->_gpio_pin_dr);
+  } else {
+    ESP_LOGCONFIG(TAG, "  DR Pin: not wired, status polled every %u ms", STATUS_POLL_INTERVAL);
   }
   if (this->_gpio_pin_cd != NULL) {
     LOG_PIN("  CD Pin:", this->_gpio_pin_cd);
@@ -85,28 +123,137 @@ void nRF905::dump_config() {
   LOG_PIN("  CE Pin:", this->_gpio_pin_ce);
   LOG_PIN("  PWR Pin:", this->_gpio_pin_pwr);
   LOG_PIN("  TXEN Pin:", this->_gpio_pin_txen);
+  ESP_LOGCONFIG(TAG, "  SPI status       %u x, %u bytes", this->_spiTransfers[SpiOpStatus],
+                this->_spiBytes[SpiOpStatus]);
+  ESP_LOGCONFIG(TAG, "  SPI config       read %u x, write %u x, %u bytes", this->_spiTransfers[SpiOpConfigRead],
+                this->_spiTransfers[SpiOpConfigWrite],
+                this->_spiBytes[SpiOpConfigRead] + this->_spiBytes[SpiOpConfigWrite]);
+  ESP_LOGCONFIG(TAG, "  SPI TX address   read %u x, write %u x, %u bytes", this->_spiTransfers[SpiOpTxAddressRead],
+                this->_spiTransfers[SpiOpTxAddressWrite],
+                this->_spiBytes[SpiOpTxAddressRead] + this->_spiBytes[SpiOpTxAddressWrite]);
+  ESP_LOGCONFIG(TAG, "  SPI TX payload   read %u x, write %u x, %u bytes", this->_spiTransfers[SpiOpTxPayloadRead],
+                this->_spiTransfers[SpiOpTxPayloadWrite],
+                this->_spiBytes[SpiOpTxPayloadRead] + this->_spiBytes[SpiOpTxPayloadWrite]);
+  ESP_LOGCONFIG(TAG, "  SPI RX payload   %u x, %u bytes", this->_spiTransfers[SpiOpRxPayloadRead],
+                this->_spiBytes[SpiOpRxPayloadRead]);
+  ESP_LOGCONFIG(TAG, "  Mode pin writes  %u (skipped %u)",
+                this->_pinCe.getWrites() + this->_pinPwr.getWrites() + this->_pinTxen.getWrites(),
+                this->_pinCe.getElided() + this->_pinPwr.getElided() + this->_pinTxen.getElided());
+  this->getModeTimes(modeTimes);
+  ESP_LOGCONFIG(TAG, "  Mode time        down %u s, standby %u s, RX %u s, TX %u ms", modeTimes[PowerDown] / 1000,
+                modeTimes[Idle] / 1000, modeTimes[Receive] / 1000, modeTimes[Transmit]);
+  ESP_LOGCONFIG(TAG, "  RX dedup window  %u ms, %u repeats dropped", this->_rxDedup.getWindow(),
+                this->_rxDedup.getDuplicates());
+  if (this->_occupancyEnabled == true) {
+    ESP_LOGCONFIG(TAG, "  Occupancy every  %u ms", this->_occupancyInterval);
+    this->_occupancy.dump_config(TAG);
+    LOG_SENSOR("  ", "Busy", this->_busySensor);
+    LOG_SENSOR("  ", "Bursts", this->_burstsSensor);
+    LOG_SENSOR("  ", "Longest burst", this->_longestBurstSensor);
+  }
+  ESP_LOGCONFIG(TAG, "  RAM: object %u bytes, hex buffer %u bytes", sizeof(nRF905), NRF905_HEX_STR_SIZE);
+#ifdef USE_ESP32
+  if (this->_runInTask == true) {
+    ESP_LOGCONFIG(TAG, "  Radio task log   %u lines dropped", radioLog.getDropped());
+  }
+#endif
 }
 
 void nRF905::loop() {
-  static uint8_t lastState = 0x00;
-  static bool addrMatch;
+#ifdef USE_ESP32
+  // Lines logged on the radio task since the last loop
+  radioLog.flush();
+#endif
+
+  // Only after a pin edge; without the DR pin, the status interval polls instead
+  if ((this->_runInTask == false) && (this->_wake == true)) {
+    this->process();
+  }
+}
+
+void IRAM_ATTR nRF905::cdInterrupt(nRF905 *const pThis) {
+  pThis->_occupancy.edge(pThis->_cdIsrPin.digital_read(), micros());
+  pThis->_wake = true;
+}
+
+void IRAM_ATTR nRF905::stateInterrupt(nRF905 *const pThis) { pThis->_wake = true; }
+
+void nRF905::occupancyProcess(void) {
+  this->_occupancy.process();
+
+  if ((this->_clock->millis() - this->_occupancyWindowStart) >= this->_occupancyInterval) {
+    this->_occupancyWindowStart = this->_clock->millis();
+    (void) this->_occupancyWindows.push(this->_occupancy.closeWindow(micros(), this->_hour));
+  }
+}
+
+void nRF905::occupancyPublish(void) {
+  OccupancyWindow window;
+
+  // Hour of the day from the time source when it has synced, else since boot
+  this->_hour = (this->_clock->millis() / 3600000) % 24;
+#ifdef USE_TIME
+  if (this->_time != NULL) {
+    const ESPTime now = this->_time->now();
+    if (now.is_valid()) {
+      this->_hour = now.hour;
+    }
+  }
+#endif
+
+  while (this->_occupancyWindows.pop(&window) == true) {
+    ESP_LOGD(TAG, "Channel busy %.2f%%, %u bursts, longest %u ms", window.busyFraction * 100.0f, window.bursts,
+             window.longestBurst);
+    if (this->_busySensor != NULL) {
+      this->_busySensor->publish_state(window.busyFraction * 100.0f);
+    }
+    if (this->_burstsSensor != NULL) {
+      this->_burstsSensor->publish_state(window.bursts);
+    }
+    if (this->_longestBurstSensor != NULL) {
+      this->_longestBurstSensor->publish_state(window.longestBurst);
+    }
+  }
+}
+
+void nRF905::process(void) {
+  uint8_t lastState;
   uint8_t buffer[NRF905_MAX_FRAMESIZE];
 
-  uint8_t state = this->readStatus() & ((1 << NRF905_STATUS_DR) | (1 << NRF905_STATUS_AM));
-  if (lastState != state) {
+  MEMORY_STACK_BEGIN();
+  memoryMeter.heapBegin();
+
+  // Cleared before the pins are read; an edge from here on is seen by the next call
+  this->_wake = false;
+
+  if (this->_occupancyEnabled == true) {
+    this->occupancyProcess();
+  }
+
+  // Nothing arrives in standby or power down, so there is no status to read
+  uint8_t state = ((this->_mode == Receive) || (this->_mode == Transmit)) ? this->readState() : 0x00;
+  if (this->_lastState != state) {
+    // Stored before the callbacks; a frame they start clears it again, so its own TX ready is seen as a change
+    lastState = this->_lastState;
+    this->_lastState = state;
+
     ESP_LOGV(TAG, "State change: 0x%02X -> 0x%02X", lastState, state);
     if (state == ((1 << NRF905_STATUS_DR) | (1 << NRF905_STATUS_AM))) {
-      addrMatch = false;
+      this->_addrMatch = false;
 
-      // Read data
+      // Read data; this clears DR and AM, so the next frame is a change even when no poll sees them low in between
       this->readRxPayload(buffer, NRF905_MAX_FRAMESIZE);
-      ESP_LOGV(TAG, "RX Complete: %s", hexArrayToStr(buffer, NRF905_MAX_FRAMESIZE));
+      this->_lastState = 0x00;
 
-      if (this->onRxComplete != NULL) {
-        this->onRxComplete(buffer, NRF905_MAX_FRAMESIZE);
+      if (this->_rxDedup.isDuplicate(buffer, this->_config.rx_payload_width, this->_clock->millis()) == false) {
+        ESP_LOGV(TAG, "RX Complete: %s", hexArrayToStr(buffer, NRF905_MAX_FRAMESIZE));
+
+        if (this->onRxComplete) {
+          this->onRxComplete(buffer, NRF905_MAX_FRAMESIZE);
+        }
       }
     } else if (state == (1 << NRF905_STATUS_DR)) {
-      addrMatch = false;
+      this->_addrMatch = false;
 
       // ESP_LOGD(TAG, "TX Ready; retransmits: %u", this->retransmitCounter);
       // if (this->retransmitCounter > 0) {
@@ -114,65 +261,65 @@ void nRF905::loop() {
       // } else {
       this->setMode(this->nextMode);
 
-      if (this->onTxReady != NULL) {
+      if (this->onTxReady) {
         this->onTxReady();
       }
       // }
     } else if (state == (1 << NRF905_STATUS_AM)) {
-      addrMatch = true;
+      this->_addrMatch = true;
       ESP_LOGD(TAG, "Addr match");
 
       // if (onAddrMatch != NULL)
       //   onAddrMatch(this);
-    } else if (state == 0 && addrMatch) {
-      addrMatch = false;
+    } else if (state == 0 && this->_addrMatch) {
+      this->_addrMatch = false;
       ESP_LOGD(TAG, "Rx Invalid");
       // if (onRxInvalid != NULL)
       //   onRxInvalid(this);
     }
-
-    lastState = state;
   }
 
   // _drPrev = _drNew;
+
+  memoryMeter.heapEnd();
+  memoryMeter.stackEnd();
 }
 
 void nRF905::setMode(const Mode mode) {
-  // Set power
-  switch (mode) {
-    case PowerDown:
-      this->_gpio_pin_pwr->digital_write(false);
-      break;
+  // Pins only change when the level differs; most transitions touch one pin
+  this->_pinPwr.write(mode != PowerDown);
+  this->_pinCe.write((mode == Receive) || (mode == Transmit));
+  this->_pinTxen.write(mode == Transmit);
 
-    default:
-      this->_gpio_pin_pwr->digital_write(true);
-      break;
+  if (mode != this->_mode) {
+    const uint32_t now = this->_clock->millis();
+
+    this->_modeTime[this->_mode] += now - this->_modeSince;
+    this->_modeSince = now;
   }
+  this->_mode = mode;
+}
 
-  // Set CE
-  switch (mode) {
-    case Receive:  // fall through
-    case Transmit:
-      this->_gpio_pin_ce->digital_write(true);
-      break;
+void nRF905::getModeTimes(uint32_t *const pTimes) const {
+  (void) memcpy(pTimes, this->_modeTime, sizeof(this->_modeTime));
+  pTimes[this->_mode] += this->_clock->millis() - this->_modeSince;
+}
 
-    default:
-      this->_gpio_pin_ce->digital_write(false);
-      break;
+Mode nRF905::spiBegin(void) {
+  const Mode mode = this->_mode;
+
+  // Registers are accessible in standby and power down; only leave RX/TX
+  if ((mode != Idle) && (mode != PowerDown)) {
+    this->setMode(Idle);
   }
 
-  // Enable TX
-  switch (mode) {
-    case Transmit:
-      this->_gpio_pin_txen->digital_write(true);
-      break;
+  return mode;
+}
 
-    default:
-      this->_gpio_pin_txen->digital_write(false);
-      break;
+void nRF905::spiEnd(const Mode mode) {
+  if (mode != this->_mode) {
+    this->setMode(mode);
   }
-
-  this->_mode = mode;
 }
 
 void nRF905::updateConfig(Config *config, uint8_t *const pStatus) {
@@ -185,16 +332,15 @@ void nRF905::readConfigRegisters(uint8_t *const pStatus) {
   Mode mode;
   ConfigBuffer buffer;
 
-  // Set mode to idle
-  mode = this->_mode;
-  this->setMode(Idle);
+  // SPI access needs standby
+  mode = this->spiBegin();
 
   // Prepare data
   buffer.command = NRF905_COMMAND_R_CONFIG;
   (void) memset(buffer.data, 0, sizeof(buffer.data));
 
   // Transfer
-  this->spiTransfer((uint8_t *) &buffer, sizeof(ConfigBuffer));
+  this->spiTransfer(SpiOpConfigRead, (uint8_t *) &buffer, sizeof(ConfigBuffer));
   if (pStatus != NULL) {
     *pStatus = buffer.command;
   }
@@ -204,31 +350,33 @@ void nRF905::readConfigRegisters(uint8_t *const pStatus) {
   this->decodeConfigRegisters(&buffer, &this->_config);
 
   // Restore mode
-  this->setMode(mode);
+  this->spiEnd(mode);
 }
 
 void nRF905::writeConfigRegisters(uint8_t *const pStatus) {
-  Mode mode;
   ConfigBuffer buffer;
+
+  this->printConfig(&this->_config);
+  this->encodeConfigRegisters(&this->_config, &buffer);
+  this->writeConfigBuffer(&buffer, pStatus);
+}
+
+void nRF905::writeConfigBuffer(ConfigBuffer *const pBuffer, uint8_t *const pStatus) {
+  Mode mode;
 #if CHECK_REG_WRITE
   uint8_t writeData[NRF905_REGISTER_COUNT];
 #endif
 
-  mode = this->_mode;
-  this->setMode(Idle);
-
-  this->printConfig(&this->_config);
+  mode = this->spiBegin();
 
-  // Create data
-  buffer.command = NRF905_COMMAND_W_CONFIG;
-  this->encodeConfigRegisters(&this->_config, &buffer);
+  pBuffer->command = NRF905_COMMAND_W_CONFIG;
 
-  ESP_LOGV(TAG, "Write config data: %s", hexArrayToStr(buffer.data, NRF905_REGISTER_COUNT));
+  ESP_LOGV(TAG, "Write config data: %s", hexArrayToStr(pBuffer->data, NRF905_REGISTER_COUNT));
 #if CHECK_REG_WRITE
-  (void) memcpy(writeData, buffer.data, NRF905_REGISTER_COUNT);
+  (void) memcpy(writeData, pBuffer->data, NRF905_REGISTER_COUNT);
 #endif
 
-  this->spiTransfer((uint8_t *) &buffer, sizeof(ConfigBuffer));
+  this->spiTransfer(SpiOpConfigWrite, (uint8_t *) pBuffer, sizeof(ConfigBuffer));
 
 #if CHECK_REG_WRITE
   // Check config write by reading config back and compare
@@ -238,7 +386,7 @@ void nRF905::writeConfigRegisters(uint8_t *const pStatus) {
     bufferRead.command = NRF905_COMMAND_R_CONFIG;
     (void) memset(bufferRead.data, 0, NRF905_REGISTER_COUNT);
 
-    this->spiTransfer((uint8_t *) &bufferRead, sizeof(ConfigBuffer));
+    this->spiTransfer(SpiOpConfigRead, (uint8_t *) &bufferRead, sizeof(ConfigBuffer));
     if (memcmp((void *) writeData, (void *) bufferRead.data, NRF905_REGISTER_COUNT) != 0) {
       ESP_LOGE(TAG, "Config write failed");
     } else {
@@ -248,11 +396,11 @@ void nRF905::writeConfigRegisters(uint8_t *const pStatus) {
 #endif
 
   if (pStatus != NULL) {
-    *pStatus = buffer.command;
+    *pStatus = pBuffer->command;
   }
 
   // Restore mode
-  this->setMode(mode);
+  this->spiEnd(mode);
 }
 
 void nRF905::writeTxAddress(const uint32_t txAddress, uint8_t *const pStatus) {
@@ -261,8 +409,9 @@ void nRF905::writeTxAddress(const uint32_t txAddress, uint8_t *const pStatus) {
 
   ESP_LOGD(TAG, "Set TX Address: 0x%08X", txAddress);
 
-  mode = this->_mode;
-  this->setMode(Idle);
+  this->_txAddress = txAddress;
+
+  mode = this->spiBegin();
 
   buffer.command = NRF905_COMMAND_W_TX_ADDRESS;
   buffer.address[3] = (txAddress >> 24) & 0xFF;
@@ -270,27 +419,26 @@ void nRF905::writeTxAddress(const uint32_t txAddress, uint8_t *const pStatus) {
   buffer.address[1] = (txAddress >> 8) & 0xFF;
   buffer.address[0] = (txAddress) &0xFF;
 
-  this->spiTransfer((uint8_t *) &buffer, sizeof(AddressBuffer));
+  this->spiTransfer(SpiOpTxAddressWrite, (uint8_t *) &buffer, sizeof(AddressBuffer));
 
   if (pStatus != NULL) {
     *pStatus = buffer.command;
   }
 
   // Restore mode
-  this->setMode(mode);
+  this->spiEnd(mode);
 }
 
 void nRF905::readTxAddress(uint32_t *pTxAddress, uint8_t *const pStatus) {
   Mode mode;
   AddressBuffer buffer;
 
-  mode = this->_mode;
-  this->setMode(Idle);
+  mode = this->spiBegin();
 
   buffer.command = NRF905_COMMAND_R_TX_ADDRESS;
   (void) memset(buffer.address, 0, 4);
 
-  this->spiTransfer((uint8_t *) &buffer, sizeof(AddressBuffer));
+  this->spiTransfer(SpiOpTxAddressRead, (uint8_t *) &buffer, sizeof(AddressBuffer));
 
   *pTxAddress = buffer.address[0];
   *pTxAddress |= (buffer.address[1] << 8);
@@ -303,7 +451,7 @@ void nRF905::readTxAddress(uint32_t *pTxAddress, uint8_t *const pStatus) {
     *pStatus = buffer.command;
   }
 
-  this->setMode(mode);
+  this->spiEnd(mode);
 }
 
 void nRF905::readTxPayload(uint8_t *const pData, const uint8_t dataLength, uint8_t *const pStatus) {
@@ -322,17 +470,16 @@ void nRF905::readTxPayload(uint8_t *const pData, const uint8_t dataLength, uint8
   buffer.command = NRF905_COMMAND_R_TX_PAYLOAD;
   (void) memset(buffer.payload, 0, NRF905_MAX_FRAMESIZE);
 
-  mode = this->_mode;
-  this->setMode(Idle);
+  mode = this->spiBegin();
 
-  this->spiTransfer((uint8_t *) &buffer, sizeof(Buffer));
+  this->spiTransfer(SpiOpTxPayloadRead, (uint8_t *) &buffer, sizeof(Buffer));
   (void) memcpy(pData, buffer.payload, dataLength);
 
   if (pStatus != NULL) {
     *pStatus = buffer.command;
   }
 
-  this->setMode(mode);
+  this->spiEnd(mode);
 }
 
 void nRF905::writeTxPayload(const uint8_t *const pData, const uint8_t dataLength, uint8_t *const pStatus) {
@@ -356,15 +503,42 @@ void nRF905::writeTxPayload(const uint8_t *const pData, const uint8_t dataLength
   buffer.command = NRF905_COMMAND_W_TX_PAYLOAD;
   (void) memcpy(buffer.payload, (uint8_t *) pData, dataLength);
 
-  mode = this->_mode;
-  this->setMode(Idle);
+  // Keep a copy for restoring after a power cycle
+  if (pData != this->_txPayload) {
+    (void) memcpy(this->_txPayload, pData, dataLength);
+    this->_txPayloadLength = dataLength;
+  }
 
-  this->spiTransfer((uint8_t *) &buffer, sizeof(Buffer));
+  mode = this->spiBegin();
+
+  this->spiTransfer(SpiOpTxPayloadWrite, (uint8_t *) &buffer, sizeof(Buffer));
   if (pStatus != NULL) {
     *pStatus = buffer.command;
   }
 
-  this->setMode(mode);
+  this->spiEnd(mode);
+}
+
+void nRF905::restoreRegisters(void) {
+  ESP_LOGD(TAG, "Restore registers");
+
+  this->writeConfigRegisters();
+  this->writeTxAddress(this->_txAddress);
+  if (this->_txPayloadLength > 0) {
+    this->writeTxPayload(this->_txPayload, this->_txPayloadLength);
+  }
+}
+
+void nRF905::powerCycle(void) {
+  ESP_LOGW(TAG, "Power cycle radio");
+
+  this->setMode(PowerDown);
+  this->_clock->delay(POWER_UP_DELAY);
+  this->setMode(Idle);
+  this->_clock->delay(POWER_UP_DELAY);  // Wait until the radio reached standby before writing registers
+
+  // Registers may have been lost; write back what we know
+  this->restoreRegisters();
 }
 
 void nRF905::readRxPayload(uint8_t *const pData, const uint8_t dataLength, uint8_t *const pStatus) {
@@ -382,7 +556,7 @@ void nRF905::readRxPayload(uint8_t *const pData, const uint8_t dataLength, uint8
   buffer.command = NRF905_COMMAND_R_RX_PAYLOAD;
   (void) memset(buffer.payload, 0, NRF905_MAX_FRAMESIZE);
 
-  this->spiTransfer((uint8_t *) &buffer, sizeof(Buffer));
+  this->spiTransfer(SpiOpRxPayloadRead, (uint8_t *) &buffer, sizeof(Buffer));
 
   (void) memcpy(pData, buffer.payload, dataLength);
 
@@ -395,7 +569,7 @@ void nRF905::readRxPayload(uint8_t *const pData, const uint8_t dataLength, uint8
 void nRF905::decodeConfigRegisters(const ConfigBuffer *const pBuffer, Config *const pConfig) {
   pConfig->channel = ((pBuffer->data[1] & 0x01) << 8) | pBuffer->data[0];
   pConfig->band = (pBuffer->data[1] & 0x02) ? true : false;
-  pConfig->rx_power = (RxPower)(pBuffer->data[1] & 0x10);
+  pConfig->rx_power = (pBuffer->data[1] & 0x10) ? PowerReduced : PowerNormal;
   pConfig->auto_retransmit = (pBuffer->data[1] & 0x20) ? true : false;
   pConfig->rx_address_width = pBuffer->data[2] & 0x07;
   pConfig->tx_address_width = (pBuffer->data[2] >> 4) & 0x07;
@@ -530,6 +704,12 @@ bool nRF905::airwayBusy(void) {
     busy = this->_gpio_pin_cd->digital_read() == true;
   }
 
+  // With the profiler, a repeat of the same burst is likely to follow shortly; wait for a real gap
+  if ((busy == false) && (this->_occupancyEnabled == true)) {
+    this->_occupancy.process();
+    busy = this->_occupancy.isQuiet(micros()) == false;
+  }
+
   return busy;
 }
 
@@ -537,7 +717,7 @@ void nRF905::startTx(const uint32_t retransmit, const Mode nextMode) {
   bool update = false;
   if (this->_mode == PowerDown) {
     this->setMode(Idle);
-    delay(3);  // Delay is needed to the radio has time to power-up and see the standby/TX pins pulse
+    this->_clock->delay(POWER_UP_DELAY);  // Delay is needed to the radio has time to power-up and see the standby/TX pins pulse
   }
 
   // Update counters
@@ -549,28 +729,62 @@ void nRF905::startTx(const uint32_t retransmit, const Mode nextMode) {
   //   this->_config.auto_retransmit = true;
   //   update = true;
   // } else if ((this->_config.auto_retransmit == true) && (retransmit == 0)) {
-  this->_config.auto_retransmit = false;
-  update = true;
+  if (this->_config.auto_retransmit == true) {
+    this->_config.auto_retransmit = false;
+    update = true;
+  }
   // }
   if (update == true) {
     this->writeConfigRegisters();
   }
 
-  // Start transmit
+  // Start transmit; DR of the previous frame may still be the last state seen, and this frame's DR must be a change
+  this->_lastState = 0x00;
   this->setMode(Transmit);
 }
 
+uint8_t nRF905::readState(void) {
+  uint8_t state;
+
+  // The DR and AM pins mirror the status bits; with DR low there is nothing to act on, so skip the SPI read. AM is
+  // then only known from its pin; an earlier status would report an address match that is long over and hide the
+  // invalid frame that may follow it, so without the pin AM reads as clear.
+  if ((this->_gpio_pin_dr != NULL) && (this->_gpio_pin_dr->digital_read() == false)) {
+    if ((this->_gpio_pin_am != NULL) && (this->_gpio_pin_am->digital_read() == true)) {
+      state = 1 << NRF905_STATUS_AM;
+    } else {
+      state = 0x00;
+    }
+  } else {
+    state = this->readStatus() & ((1 << NRF905_STATUS_DR) | (1 << NRF905_STATUS_AM));
+  }
+
+  return state;
+}
+
 uint8_t nRF905::readStatus(void) {
   uint8_t status = 0;
 
   status = NRF905_COMMAND_NOP;
 
-  this->spiTransfer(&status, 1);
+  this->spiTransfer(SpiOpStatus, &status, 1);
 
   return status;
 }
 
-void nRF905::spiTransfer(uint8_t *const data, const size_t length) {
+void nRF905::getBusCounters(BusCounters *const pCounters) const {
+  (void) memcpy(pCounters->transfers, this->_spiTransfers, sizeof(pCounters->transfers));
+  (void) memcpy(pCounters->bytes, this->_spiBytes, sizeof(pCounters->bytes));
+  pCounters->pinWrites = this->_pinCe.getWrites() + this->_pinPwr.getWrites() + this->_pinTxen.getWrites();
+  pCounters->pinWritesElided = this->_pinCe.getElided() + this->_pinPwr.getElided() + this->_pinTxen.getElided();
+}
+
+void nRF905::spiTransfer(const SpiOp op, uint8_t *const data, const size_t length) {
+  MEMORY_STACK_SAMPLE();
+
+  ++this->_spiTransfers[op];
+  this->_spiBytes[op] += length;
+
   this->enable();
 
   this->transfer_array(data, length);
@@ -579,14 +793,14 @@ void nRF905::spiTransfer(uint8_t *const data, const size_t length) {
 }
 
 char *nRF905::hexArrayToStr(const uint8_t *const pData, const size_t dataLength) {
-  static char buf[256];
+  static char buf[NRF905_HEX_STR_SIZE];
   size_t bufIdx = 0;
 
   for (size_t i = 0; i < dataLength; ++i) {
     if (i > 0) {
-      bufIdx += snprintf(&buf[bufIdx], 256 - bufIdx, " ");
+      bufIdx += snprintf(&buf[bufIdx], NRF905_HEX_STR_SIZE - bufIdx, " ");
     }
-    bufIdx += snprintf(&buf[bufIdx], 256 - bufIdx, "0x%02X", pData[i]);
+    bufIdx += snprintf(&buf[bufIdx], NRF905_HEX_STR_SIZE - bufIdx, "0x%02X", pData[i]);
   }
 
   return buf;
@@ -2,20 +2,34 @@
 #define __COMPONENT_nRF905_H__
 
 #include "esphome/core/component.h"
+#include "esphome/core/defines.h"
 #include "esphome/core/hal.h"
 #include "esphome/core/helpers.h"
 #include "esphome/components/spi/spi.h"
-#include "nRF905.h"
+#include "esphome/components/sensor/sensor.h"
+#ifdef USE_TIME
+#include "esphome/components/time/real_time_clock.h"
+#endif
+#include "clock.h"
+#include "dedup.h"
+#include "fast_pin.h"
+#include "inplace_function.h"
+#include "memory.h"
+#include "occupancy.h"
 
 namespace esphome {
 namespace nrf905 {
 
-#define MAX_TRANSMIT_TIME 2000      // TODO figure out what timeout we want
-#define CARRIERDETECT_LED_DELAY 20  // On-board LED will light up for 20ms when data is received
+#define MAX_TRANSMIT_TIME 250            // A 16 byte frame takes ~5ms on air; allow for main loop latency
+#define POWER_UP_DELAY 3                 // Time needed from power down to standby (ms)
+#define CARRIERDETECT_LED_DELAY 20       // On-board LED will light up for 20ms when data is received
+#define OCCUPANCY_PUBLISH_INTERVAL 1000  // Closed occupancy windows are published this often (ms)
+#define STATUS_POLL_INTERVAL 10          // Status register poll when the DR pin is not wired (ms)
 
 /* nRF905 register sizes */
 #define NRF905_REGISTER_COUNT 10
 #define NRF905_MAX_FRAMESIZE 32
+#define NRF905_HEX_STR_SIZE (NRF905_MAX_FRAMESIZE * 5)  // "0xXX" and a separator or terminator per byte
 
 /* nRF905 Instructions */
 #define NRF905_COMMAND_NOP 0xFF
@@ -38,6 +52,7 @@ typedef enum {
 } nRF905Cc;
 
 typedef enum { PowerDown, Idle, Receive, Transmit } Mode;
+#define NRF905_MODE_COUNT 4
 
 typedef enum {
   ClkOut4000000 = 0x00,
@@ -48,6 +63,26 @@ typedef enum {
 
 typedef enum { PowerNormal = 0x00, PowerReduced = 0x01 } RxPower;
 
+typedef enum {
+  SpiOpStatus,
+  SpiOpConfigRead,
+  SpiOpConfigWrite,
+  SpiOpTxAddressRead,
+  SpiOpTxAddressWrite,
+  SpiOpTxPayloadRead,
+  SpiOpTxPayloadWrite,
+  SpiOpRxPayloadRead,
+
+  SpiOpNrOf  // Keep last
+} SpiOp;
+
+typedef struct {
+  uint32_t transfers[SpiOpNrOf];  // SPI transactions, each one CS cycle
+  uint32_t bytes[SpiOpNrOf];      // Bytes clocked
+  uint32_t pinWrites;             // Mode pin writes that changed a level
+  uint32_t pinWritesElided;       // Mode pin writes skipped, level already right
+} BusCounters;
+
 typedef struct {
   uint16_t channel;          // nRF905 RF channel
   bool band;                 // nRF905 href_ppl: false=434MHz band, true=868MHZ band
@@ -83,8 +118,15 @@ typedef struct {
   uint8_t payload[NRF905_MAX_FRAMESIZE];
 } Buffer;
 
-typedef std::function<void(void)> TxReadyCalllback;
-typedef std::function<void(const uint8_t *const pBuffer, const uint8_t size)> RxCompleteCallback;
+class SystemClock : public Clock {
+ public:
+  uint32_t millis(void) override { return esphome::millis(); }
+  void delay(const uint32_t ms) override { esphome::delay(ms); }
+};
+extern SystemClock systemClock;
+
+typedef InplaceFunction<void(void)> TxReadyCalllback;
+typedef InplaceFunction<void(const uint8_t *const pBuffer, const uint8_t size)> RxCompleteCallback;
 
 class nRF905 : public Component,
                public spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST, spi::CLOCK_POLARITY_LOW, spi::CLOCK_PHASE_LEADING,
@@ -94,21 +136,52 @@ class nRF905 : public Component,
 
   void setup() override;
 
-  // float get_setup_priority() const override { return setup_priority::HARDWARE; }
-  float get_setup_priority() const override { return setup_priority::AFTER_CONNECTION; }
+  // Radio registers must be in place before the components using the radio set up
+  float get_setup_priority() const override { return setup_priority::HARDWARE; }
 
   void dump_config() override;
   void loop() override;
 
-  void set_am_pin(GPIOPin *const pin) { _gpio_pin_am = pin; }
-  void set_cd_pin(GPIOPin *const pin) { _gpio_pin_cd = pin; }
-  void set_ce_pin(GPIOPin *const pin) { _gpio_pin_ce = pin; }
-  void set_dr_pin(GPIOPin *const pin) { _gpio_pin_dr = pin; }
-  void set_pwr_pin(GPIOPin *const pin) { _gpio_pin_pwr = pin; }
-  void set_txen_pin(GPIOPin *const pin) { _gpio_pin_txen = pin; }
-
-  void setOnRxComplete(RxCompleteCallback callback) { onRxComplete = callback; }
-  void setOnTxReady(TxReadyCalllback callback) { onTxReady = callback; }
+  // Poll the radio; called by loop(), or by the owner's thread when the radio runs in a task
+  void process(void);
+  void setRunInTask(const bool runInTask) { this->_runInTask = runInTask; }
+
+  // With DR wired, the main loop only polls the radio after a DR or AM edge; without it, the status register is read
+  // over SPI every STATUS_POLL_INTERVAL
+  void set_am_pin(InternalGPIOPin *const pin) { _gpio_pin_am = pin; }
+  void set_cd_pin(InternalGPIOPin *const pin) { _gpio_pin_cd = pin; }
+  void set_ce_pin(InternalGPIOPin *const pin) { _gpio_pin_ce = pin; }
+  void set_dr_pin(InternalGPIOPin *const pin) { _gpio_pin_dr = pin; }
+  void set_pwr_pin(InternalGPIOPin *const pin) { _gpio_pin_pwr = pin; }
+  void set_txen_pin(InternalGPIOPin *const pin) { _gpio_pin_txen = pin; }
+
+  void set_clock(Clock *const pClock) { _clock = pClock; }
+
+  // Channel occupancy profiling; needs the CD pin
+  void set_occupancy(const bool enable) { _occupancyEnabled = enable; }
+  void set_occupancy_interval(const uint32_t interval) { _occupancyInterval = interval; }
+  void set_busy_sensor(sensor::Sensor *const pSensor) { _busySensor = pSensor; }
+  void set_bursts_sensor(sensor::Sensor *const pSensor) { _burstsSensor = pSensor; }
+  void set_longest_burst_sensor(sensor::Sensor *const pSensor) { _longestBurstSensor = pSensor; }
+#ifdef USE_TIME
+  void set_time(time::RealTimeClock *const pTime) { _time = pTime; }
+#endif
+  const OccupancyProfiler *getOccupancy(void) const { return this->_occupancyEnabled ? &this->_occupancy : NULL; }
+  uint8_t getHour(void) const { return this->_hour; }
+
+  // Repeats of a received frame within the window are counted, not passed on; 0 disables
+  void set_rx_dedup_window(const uint32_t window) { _rxDedup.set_window(window); }
+  uint32_t getRxDuplicates(void) const { return this->_rxDedup.getDuplicates(); }
+
+  // Always-on bus cost counters; take two snapshots to measure an operation
+  void getBusCounters(BusCounters *const pCounters) const;
+  Clock *getClock(void) { return this->_clock; }
+
+  // Time spent in each mode since boot (ms), indexed by Mode; includes the mode the radio is in now
+  void getModeTimes(uint32_t *const pTimes) const;
+
+  void setOnRxComplete(RxCompleteCallback callback) { onRxComplete = std::move(callback); }
+  void setOnTxReady(TxReadyCalllback callback) { onTxReady = std::move(callback); }
 
   Mode getMode(void) { return this->_mode; };
   void setMode(const Mode mode);
@@ -122,6 +195,10 @@ class nRF905 : public Component,
   void writeTxPayload(const uint8_t *const pData, const uint8_t dataLength, uint8_t *const pStatus = NULL);
   void readTxPayload(uint8_t *const pData, const uint8_t dataLength, uint8_t *const pStatus = NULL);
 
+  // Recovery helpers, used when the radio stops responding
+  void restoreRegisters(void);
+  void powerCycle(void);
+
   bool airwayBusy(void);
 
   void startTx(const uint32_t retransmit, const Mode nextMode);
@@ -133,32 +210,78 @@ class nRF905 : public Component,
 
   void readConfigRegisters(uint8_t *const pStatus = NULL);
   void writeConfigRegisters(uint8_t *const pStatus = NULL);
+  void writeConfigBuffer(ConfigBuffer *const pBuffer, uint8_t *const pStatus = NULL);
 
   void decodeConfigRegisters(const ConfigBuffer *const pBuffer, Config *const pConfig);
   void encodeConfigRegisters(const Config *const pConfig, ConfigBuffer *const pBuffer);
 
   uint8_t readStatus(void);
+  uint8_t readState(void);
+
+  Mode spiBegin(void);
+  void spiEnd(const Mode mode);
 
-  void spiTransfer(uint8_t *const data, const size_t length);
+  static void cdInterrupt(nRF905 *const pThis);
+  static void stateInterrupt(nRF905 *const pThis);
+  void occupancyProcess(void);
+  void occupancyPublish(void);
+
+  void spiTransfer(const SpiOp op, uint8_t *const data, const size_t length);
 
   char *hexArrayToStr(const uint8_t *const pData, const size_t dataLength);
 
-  RxCompleteCallback onRxComplete{NULL};
+  RxCompleteCallback onRxComplete;
 
   uint32_t retransmitCounter{0};
   Mode nextMode{PowerDown};
-  TxReadyCalllback onTxReady{NULL};
-
-  GPIOPin *_gpio_pin_am{NULL};
-  GPIOPin *_gpio_pin_cd{NULL};
-  GPIOPin *_gpio_pin_ce{NULL};
-  GPIOPin *_gpio_pin_dr{NULL};
-  GPIOPin *_gpio_pin_pwr{NULL};
-  GPIOPin *_gpio_pin_txen{NULL};
+  TxReadyCalllback onTxReady;
+
+  uint8_t _lastState{0x00};  // DR and AM as last seen by process()
+  bool _addrMatch{false};    // Address match seen, frame not complete yet
+  volatile bool _wake{false};  // DR, AM or CD edge since the last process()
+
+  InternalGPIOPin *_gpio_pin_am{NULL};
+  InternalGPIOPin *_gpio_pin_cd{NULL};
+  InternalGPIOPin *_gpio_pin_ce{NULL};
+  InternalGPIOPin *_gpio_pin_dr{NULL};
+  InternalGPIOPin *_gpio_pin_pwr{NULL};
+  InternalGPIOPin *_gpio_pin_txen{NULL};
+
+  FastPin _pinCe;
+  FastPin _pinPwr;
+  FastPin _pinTxen;
+
+  uint32_t _spiTransfers[SpiOpNrOf]{};
+  uint32_t _spiBytes[SpiOpNrOf]{};
+
+  Clock *_clock{&systemClock};
+  bool _runInTask{false};
+  RxDedup _rxDedup;
+
+  bool _occupancyEnabled{false};
+  uint32_t _occupancyInterval{60000};
+  uint32_t _occupancyWindowStart{0};
+  OccupancyProfiler _occupancy;
+  SpscQueue<OccupancyWindow, 2> _occupancyWindows;  // Closed windows, to be published from the main loop
+  ISRInternalGPIOPin _cdIsrPin;
+  uint8_t _hour{0};  // Hour of the day for the occupancy profile
+  sensor::Sensor *_busySensor{NULL};
+  sensor::Sensor *_burstsSensor{NULL};
+  sensor::Sensor *_longestBurstSensor{NULL};
+#ifdef USE_TIME
+  time::RealTimeClock *_time{NULL};
+#endif
 
   Mode _mode{PowerDown};
+  uint32_t _modeSince{0};                   // Time of the last mode change
+  uint32_t _modeTime[NRF905_MODE_COUNT]{};  // Time spent in each mode, closed periods only
 
   Config _config;
+
+  // Cached register contents, used to quickly re-initialize the radio
+  uint32_t _txAddress{0};
+  uint8_t _txPayload[NRF905_MAX_FRAMESIZE];
+  uint8_t _txPayloadLength{0};
 };
 
 }  // namespace nrf905
@@ -0,0 +1,115 @@
+#include "occupancy.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace nrf905 {
+
+static const uint16_t burstLimits[OCCUPANCY_BUCKETS - 1] = {2, 5, 10, 20, 50, 100, 200};  // Upper bounds (ms)
+
+#define OCCUPANCY_HOUR_WEIGHT 8   // Windows in the running average of an hour
+#define OCCUPANCY_HOUR_SAMPLES 8  // Windows needed before an hour is judged
+#define OCCUPANCY_BUSY_MIN 0.02f  // Busy hours are at least this busy, whatever the rest of the day does
+
+void OccupancyProfiler::process(void) {
+  OccupancyEdge edge;
+  uint32_t duration;
+  uint8_t bucket;
+
+  while (this->edges_.pop(&edge) == true) {
+    if (edge.busy == this->busy_) {
+      continue;  // Missed the opposite edge; keep the first
+    }
+
+    this->busy_ = edge.busy;
+    if (edge.busy == true) {
+      this->burstStart_ = edge.time;
+      this->busySince_ = edge.time;
+    } else {
+      duration = edge.time - this->burstStart_;
+      this->windowBusy_ += edge.time - this->busySince_;
+      this->lastBusyEnd_ = edge.time;
+
+      ++this->windowBursts_;
+      if (duration > this->windowLongest_) {
+        this->windowLongest_ = duration;
+      }
+
+      for (bucket = 0; (bucket < (OCCUPANCY_BUCKETS - 1)) && ((duration / 1000) >= burstLimits[bucket]); ++bucket) {
+      }
+      ++this->histogram_[bucket];
+    }
+  }
+}
+
+OccupancyWindow OccupancyProfiler::closeWindow(const uint32_t now, const uint8_t hour) {
+  OccupancyWindow window;
+  const uint32_t length = now - this->windowStart_;
+  float *const pHour = &this->hourBusy_[hour % OCCUPANCY_HOURS];
+
+  this->process();
+
+  // Split a burst that runs across the window boundary
+  if (this->busy_ == true) {
+    this->windowBusy_ += now - this->busySince_;
+    this->busySince_ = now;
+  }
+
+  window.busyFraction = (length > 0) ? ((float) this->windowBusy_ / (float) length) : 0.0f;
+  window.bursts = this->windowBursts_;
+  window.longestBurst = this->windowLongest_ / 1000;
+
+  if (this->hourSamples_[hour % OCCUPANCY_HOURS] == 0) {
+    *pHour = window.busyFraction;
+  } else {
+    *pHour += (window.busyFraction - *pHour) / OCCUPANCY_HOUR_WEIGHT;
+  }
+  if (this->hourSamples_[hour % OCCUPANCY_HOURS] < UINT16_MAX) {
+    ++this->hourSamples_[hour % OCCUPANCY_HOURS];
+  }
+
+  this->windowStart_ = now;
+  this->windowBusy_ = 0;
+  this->windowBursts_ = 0;
+  this->windowLongest_ = 0;
+
+  return window;
+}
+
+bool OccupancyProfiler::isBusyHour(const uint8_t hour) const {
+  float sum = 0.0f;
+  uint8_t hours = 0;
+  uint8_t i;
+
+  if (this->hourSamples_[hour % OCCUPANCY_HOURS] < OCCUPANCY_HOUR_SAMPLES) {
+    return false;
+  }
+
+  for (i = 0; i < OCCUPANCY_HOURS; ++i) {
+    if (this->hourSamples_[i] >= OCCUPANCY_HOUR_SAMPLES) {
+      sum += this->hourBusy_[i];
+      ++hours;
+    }
+  }
+
+  // Twice as busy as an average hour
+  return (this->hourBusy_[hour % OCCUPANCY_HOURS] >= OCCUPANCY_BUSY_MIN) &&
+         (this->hourBusy_[hour % OCCUPANCY_HOURS] > (2.0f * sum / hours));
+}
+
+void OccupancyProfiler::dump_config(const char *const tag) const {
+  uint8_t i;
+
+  ESP_LOGCONFIG(tag, "  Bursts (ms)      <2 %u, <5 %u, <10 %u, <20 %u, <50 %u, <100 %u, <200 %u, more %u",
+                this->histogram_[0], this->histogram_[1], this->histogram_[2], this->histogram_[3],
+                this->histogram_[4], this->histogram_[5], this->histogram_[6], this->histogram_[7]);
+  for (i = 0; i < OCCUPANCY_HOURS; ++i) {
+    if (this->hourSamples_[i] > 0) {
+      ESP_LOGCONFIG(tag, "  Hour %02u          %.2f%% busy%s", i, this->hourBusy_[i] * 100.0f,
+                    this->isBusyHour(i) ? " (busy hour)" : "");
+    }
+  }
+  ESP_LOGCONFIG(tag, "  Edges lost       %u", this->overflows_);
+}
+
+}  // namespace nrf905
+}  // namespace esphome
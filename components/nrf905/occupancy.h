@@ -0,0 +1,74 @@
+#ifndef __COMPONENT_nRF905_OCCUPANCY_H__
+#define __COMPONENT_nRF905_OCCUPANCY_H__
+
+#include <stdint.h>
+#include "spsc_queue.h"
+
+namespace esphome {
+namespace nrf905 {
+
+#define OCCUPANCY_EDGES 32      // Carrier detect edges buffered between the interrupt and the loop
+#define OCCUPANCY_QUIET_GAP 20  // Channel still counts as busy this long after a burst (ms)
+#define OCCUPANCY_BUCKETS 8     // Burst length histogram buckets
+#define OCCUPANCY_HOURS 24      // Time-of-day profile resolution
+
+typedef struct {
+  uint32_t time;  // Edge time (us)
+  bool busy;      // Carrier detect level after the edge
+} OccupancyEdge;
+
+typedef struct {
+  float busyFraction;     // Part of the window with a carrier (0 - 1)
+  uint32_t bursts;        // Bursts that ended in the window
+  uint32_t longestBurst;  // Longest of those (ms)
+} OccupancyWindow;
+
+/* Channel occupancy from carrier detect edges. The interrupt handler only queues edges; process() turns them into
+ * bursts, closeWindow() into a busy fraction per window and a per-hour busy profile. The profile marks the hours
+ * that are busier than the rest of the day, so non-urgent traffic can avoid them. */
+class OccupancyProfiler {
+ public:
+  // Interrupt context; always inlined into the IRAM_ATTR handler, so none of it runs from flash. The caller passes
+  // the time from micros(), which ESPHome keeps in IRAM; the virtual Clock is not callable from here.
+  __attribute__((always_inline)) void edge(const bool busy, const uint32_t time) {
+    const OccupancyEdge edge = {time, busy};
+
+    if (this->edges_.push(edge) == false) {
+      ++this->overflows_;
+    }
+  }
+
+  void process(void);
+  OccupancyWindow closeWindow(const uint32_t now, const uint8_t hour);
+
+  // No carrier now, nor during the last OCCUPANCY_QUIET_GAP ms
+  bool isQuiet(const uint32_t now) const {
+    return (this->busy_ == false) && ((now - this->lastBusyEnd_) >= (OCCUPANCY_QUIET_GAP * 1000));
+  }
+  bool isBusyHour(const uint8_t hour) const;
+
+  void dump_config(const char *const tag) const;
+
+ protected:
+  SpscQueue<OccupancyEdge, OCCUPANCY_EDGES> edges_;
+  volatile uint32_t overflows_{0};
+
+  bool busy_{false};
+  uint32_t burstStart_{0};    // Start of the current burst (us)
+  uint32_t busySince_{0};     // Start of the busy time not yet added to the window (us)
+  uint32_t lastBusyEnd_{0};   // End of the last burst (us)
+
+  uint32_t windowStart_{0};   // (us)
+  uint32_t windowBusy_{0};    // (us)
+  uint32_t windowBursts_{0};
+  uint32_t windowLongest_{0};  // (us)
+
+  uint32_t histogram_[OCCUPANCY_BUCKETS]{};
+  float hourBusy_[OCCUPANCY_HOURS]{};       // Average busy fraction per hour of the day
+  uint16_t hourSamples_[OCCUPANCY_HOURS]{};  // Windows averaged into each hour
+};
+
+}  // namespace nrf905
+}  // namespace esphome
+
+#endif /* __COMPONENT_nRF905_OCCUPANCY_H__ */
@@ -0,0 +1,41 @@
+#include "radio_log.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+namespace esphome {
+namespace nrf905 {
+
+#ifdef USE_ESP32
+RadioLog radioLog;
+#endif
+
+void RadioLog::log(const int level, const char *const tag, const int line, const char *const format, ...) {
+  va_list args;
+  Line entry;
+
+  va_start(args, format);
+  if (RadioThread::isCurrent() == false) {
+    esp_log_vprintf_(level, tag, line, format, args);
+  } else {
+    entry.tag = tag;
+    entry.line = line;
+    entry.level = level;
+    (void) vsnprintf(entry.text, RADIO_LOG_LINE_SIZE, format, args);
+    if (this->lines_.push(entry) == false) {
+      ++this->dropped_;
+    }
+  }
+  va_end(args);
+}
+
+void RadioLog::flush(void) {
+  Line entry;
+
+  while (this->lines_.pop(&entry) == true) {
+    esp_log_printf_(entry.level, entry.tag, entry.line, "%s", entry.text);
+  }
+}
+
+}  // namespace nrf905
+}  // namespace esphome
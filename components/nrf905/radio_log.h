@@ -0,0 +1,71 @@
+#ifndef __COMPONENT_nRF905_RADIO_LOG_H__
+#define __COMPONENT_nRF905_RADIO_LOG_H__
+
+#include <stdint.h>
+#include "esphome/core/log.h"
+#include "radio_thread.h"
+#include "spsc_queue.h"
+
+namespace esphome {
+namespace nrf905 {
+
+#define RADIO_LOG_LINES 8       // Lines queued from the radio task between two main loop iterations
+#define RADIO_LOG_LINE_SIZE 96  // Formatted line, longer ones are cut (bytes)
+
+/* Log lines from the radio task. The ESPHome logger is not task safe: its buffer and the API log callbacks belong to
+ * the main loop. Called on the radio thread, log() formats the line into a queue, and flush() in the main loop hands
+ * it to the logger; called anywhere else it logs right away. Lines that find the queue full are counted. */
+class RadioLog {
+ public:
+  void log(const int level, const char *const tag, const int line, const char *const format, ...)
+      __attribute__((format(printf, 5, 6)));
+  void flush(void);
+
+  uint32_t getDropped(void) const { return this->dropped_; }
+
+ protected:
+  typedef struct {
+    const char *tag;  // Static string of the logging source
+    uint16_t line;
+    uint8_t level;
+    char text[RADIO_LOG_LINE_SIZE];
+  } Line;
+
+  SpscQueue<Line, RADIO_LOG_LINES> lines_;
+  volatile uint32_t dropped_{0};
+};
+
+#ifdef USE_ESP32
+extern RadioLog radioLog;
+
+/* Sources with code that runs on the radio task include this header after the ESPHome log header; their log
+ * statements then go through radioLog. The radio task only exists on ESP32; elsewhere the macros stay as they are,
+ * and so does the level filtering at compile time. */
+#define RADIO_LOG(level, tag, ...) esphome::nrf905::radioLog.log(level, tag, __LINE__, __VA_ARGS__)
+
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_ERROR
+#undef ESP_LOGE
+#define ESP_LOGE(tag, ...) RADIO_LOG(ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_WARN
+#undef ESP_LOGW
+#define ESP_LOGW(tag, ...) RADIO_LOG(ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_INFO
+#undef ESP_LOGI
+#define ESP_LOGI(tag, ...) RADIO_LOG(ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG
+#undef ESP_LOGD
+#define ESP_LOGD(tag, ...) RADIO_LOG(ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
+#undef ESP_LOGV
+#define ESP_LOGV(tag, ...) RADIO_LOG(ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#endif
+#endif
+
+}  // namespace nrf905
+}  // namespace esphome
+
+#endif /* __COMPONENT_nRF905_RADIO_LOG_H__ */
@@ -0,0 +1,134 @@
+#ifndef __COMPONENT_nRF905_RADIO_THREAD_H__
+#define __COMPONENT_nRF905_RADIO_THREAD_H__
+
+#include <stdint.h>
+#include <atomic>
+#include "inplace_function.h"
+
+#ifdef USE_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+namespace esphome {
+namespace nrf905 {
+
+#define RADIO_THREAD_STACK_SIZE 4096  // Bytes
+#define RADIO_THREAD_PRIORITY 5       // Above the Arduino loop task (1), below WiFi (23)
+#define RADIO_THREAD_CORE 0           // The ESPHome main loop runs on core 1
+
+/* Runs a step function periodically in its own thread: a FreeRTOS task pinned to RADIO_THREAD_CORE on ESP32, a
+ * std::thread elsewhere, so the same radio code runs on the host. The step function must only exchange data with
+ * the main loop through SpscQueue (or plain reads of single words), and logs through RadioLog.
+ *
+ * On ESP32 the period is rounded up to whole FreeRTOS ticks, at least one: a 1 ms period is 1 ms at
+ * CONFIG_FREERTOS_HZ=1000 but 10 ms at 100 Hz. getPeriod() returns the period the thread really sleeps. */
+class RadioThread {
+ public:
+  typedef InplaceFunction<void(void)> Step;
+
+  ~RadioThread() { this->stop(); }
+
+  bool start(const char *const name, Step step, const uint32_t periodMs) {
+    if (this->running_.load() == true) {
+      return false;
+    }
+    this->step_ = std::move(step);
+    this->periodMs_ = RadioThread::roundPeriod(periodMs);
+    this->running_.store(true);
+
+#ifdef USE_ESP32
+#if portNUM_PROCESSORS > 1
+    const BaseType_t core = RADIO_THREAD_CORE;
+#else
+    const BaseType_t core = tskNO_AFFINITY;
+#endif
+    if (xTaskCreatePinnedToCore(RadioThread::entry, name, RADIO_THREAD_STACK_SIZE, this, RADIO_THREAD_PRIORITY,
+                                &this->handle_, core) != pdPASS) {
+      this->running_.store(false);
+      return false;
+    }
+#else
+    (void) name;
+    this->thread_ = std::thread(RadioThread::entry, this);
+#endif
+    return true;
+  }
+
+  void stop(void) {
+    this->running_.store(false);
+#ifndef USE_ESP32
+    if (this->thread_.joinable()) {
+      this->thread_.join();
+    }
+#endif
+  }
+
+  bool isRunning(void) const { return this->running_.load(); }
+  static bool isCurrent(void) { return RadioThread::current(); }  // Called on a radio thread
+  uint32_t getPeriod(void) const { return this->periodMs_; }  // Actual period between steps (ms)
+
+  // Period as the thread can sleep it: whole ticks, at least one, so the idle task on this core always gets to run
+  static uint32_t roundPeriod(const uint32_t ms) {
+#ifdef USE_ESP32
+    return RadioThread::ticks(ms) * portTICK_PERIOD_MS;
+#else
+    return (ms > 0) ? ms : 1;
+#endif
+  }
+
+  static void sleep(const uint32_t ms) {
+#ifdef USE_ESP32
+    vTaskDelay(RadioThread::ticks(ms));
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+#endif
+  }
+
+ protected:
+#ifdef USE_ESP32
+  // pdMS_TO_TICKS() rounds down, to 0 for anything below one tick
+  static TickType_t ticks(const uint32_t ms) {
+    const TickType_t ticks = (TickType_t) (((uint64_t) ms * configTICK_RATE_HZ + 999) / 1000);
+
+    return (ticks > 0) ? ticks : 1;
+  }
+#endif
+
+  static bool &current(void) {
+    static thread_local bool current = false;
+
+    return current;
+  }
+
+  static void entry(void *pArg) {
+    RadioThread *const pThis = (RadioThread *) pArg;
+
+    RadioThread::current() = true;
+    while (pThis->running_.load() == true) {
+      pThis->step_();
+      RadioThread::sleep(pThis->periodMs_);
+    }
+#ifdef USE_ESP32
+    pThis->handle_ = NULL;
+    vTaskDelete(NULL);
+#endif
+  }
+
+  Step step_;
+  uint32_t periodMs_{1};
+  std::atomic<bool> running_{false};
+#ifdef USE_ESP32
+  TaskHandle_t handle_{NULL};
+#else
+  std::thread thread_;
+#endif
+};
+
+}  // namespace nrf905
+}  // namespace esphome
+
+#endif /* __COMPONENT_nRF905_RADIO_THREAD_H__ */
@@ -0,0 +1,55 @@
+#ifndef __COMPONENT_nRF905_SPSC_QUEUE_H__
+#define __COMPONENT_nRF905_SPSC_QUEUE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+namespace esphome {
+namespace nrf905 {
+
+/* Fixed size, lock-free queue for exactly one producer and one consumer thread. Used to pass commands to and events
+ * from the radio task without taking a lock on either side. push() and pop() never block; a full queue returns
+ * false and the caller decides what to drop. */
+template<typename T, size_t Size> class SpscQueue {
+  static_assert((Size > 0) && ((Size & (Size - 1)) == 0), "Queue size must be a power of two");
+
+ public:
+  // Producer side; always inlined, as the carrier detect interrupt pushes from IRAM
+  __attribute__((always_inline)) bool push(const T &item) {
+    const uint32_t head = this->head_.load(std::memory_order_relaxed);
+
+    if ((head - this->tail_.load(std::memory_order_acquire)) >= Size) {
+      return false;  // Full
+    }
+    this->items_[head & (Size - 1)] = item;
+    this->head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side
+  bool pop(T *const pItem) {
+    const uint32_t tail = this->tail_.load(std::memory_order_relaxed);
+
+    if (tail == this->head_.load(std::memory_order_acquire)) {
+      return false;  // Empty
+    }
+    *pItem = this->items_[tail & (Size - 1)];
+    this->tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty(void) const {
+    return this->tail_.load(std::memory_order_acquire) == this->head_.load(std::memory_order_acquire);
+  }
+
+ protected:
+  std::atomic<uint32_t> head_{0};  // Written by the producer only
+  std::atomic<uint32_t> tail_{0};  // Written by the consumer only
+  T items_[Size];
+};
+
+}  // namespace nrf905
+}  // namespace esphome
+
+#endif /* __COMPONENT_nRF905_SPSC_QUEUE_H__ */
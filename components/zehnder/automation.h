@@ -0,0 +1,37 @@
+#ifndef __COMPONENT_ZEHNDER_AUTOMATION_H__
+#define __COMPONENT_ZEHNDER_AUTOMATION_H__
+
+#include "esphome/core/automation.h"
+#include "zehnder.h"
+
+namespace esphome {
+namespace zehnder {
+
+// Arguments: command ID, retries, latency (ms)
+class CommandSuccessTrigger : public Trigger<uint16_t, uint8_t, uint32_t> {
+ public:
+  explicit CommandSuccessTrigger(ZehnderRF *const pParent) {
+    pParent->add_on_command_callback([this](const CommandOutcome &outcome) {
+      if (outcome.result == CommandSuccess) {
+        this->trigger(outcome.id, outcome.retries, outcome.latency);
+      }
+    });
+  }
+};
+
+// Arguments: command ID, reason (timeout, replaced or rejected), retries, latency (ms)
+class CommandFailedTrigger : public Trigger<uint16_t, std::string, uint8_t, uint32_t> {
+ public:
+  explicit CommandFailedTrigger(ZehnderRF *const pParent) {
+    pParent->add_on_command_callback([this](const CommandOutcome &outcome) {
+      if (outcome.result != CommandSuccess) {
+        this->trigger(outcome.id, ZehnderRF::commandResultToStr(outcome.result), outcome.retries, outcome.latency);
+      }
+    });
+  }
+};
+
+}  // namespace zehnder
+}  // namespace esphome
+
+#endif /* __COMPONENT_ZEHNDER_AUTOMATION_H__ */
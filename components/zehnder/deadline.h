@@ -0,0 +1,28 @@
+#ifndef __COMPONENT_ZEHNDER_DEADLINE_H__
+#define __COMPONENT_ZEHNDER_DEADLINE_H__
+
+#include <stdint.h>
+
+namespace esphome {
+namespace zehnder {
+
+/* Timing checks of the protocol layer on 32 bit millisecond timestamps. Differences are taken modulo 2^32, so a
+ * period running across the millis() wraparound ends on time. tools/rfsim runs its bridges on these same functions
+ * with a virtual clock; the soak run covers the wraparound in seconds. No ESPHome dependencies. */
+
+// True once more than 'period' ms have passed since 'start'
+inline bool deadlinePassed(const uint32_t now, const uint32_t start, const uint32_t period) {
+  return (uint32_t) (now - start) > period;
+}
+
+// Time until deadlinePassed() turns true, 0 when it already is (ms)
+inline uint32_t deadlineRemaining(const uint32_t now, const uint32_t start, const uint32_t period) {
+  const uint32_t elapsed = now - start;
+
+  return (elapsed > period) ? 0 : (period - elapsed) + 1;
+}
+
+}  // namespace zehnder
+}  // namespace esphome
+
+#endif /* __COMPONENT_ZEHNDER_DEADLINE_H__ */
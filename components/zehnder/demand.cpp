@@ -0,0 +1,85 @@
+#include "demand.h"
+#include "esphome/core/log.h"
+
+#include <math.h>
+
+namespace esphome {
+namespace zehnder {
+
+void DemandController::dump_config(const char *const tag) {
+  ESP_LOGCONFIG(tag, "  Demand control     %s, setpoint %.1f", this->mode_ == DemandPi ? "PI" : "hysteresis",
+                this->setpoint_);
+  if (this->mode_ == DemandPi) {
+    ESP_LOGCONFIG(tag, "    Kp %.3f Ki %.5f", this->kp_, this->ki_);
+  } else {
+    ESP_LOGCONFIG(tag, "    Hysteresis %.1f", this->hysteresis_);
+  }
+  ESP_LOGCONFIG(tag, "    Output %u - %u, min dwell %u ms", this->low_, this->high_, this->minDwell_);
+}
+
+bool DemandController::update(const float value, const uint32_t now, uint8_t *const pOutput) {
+  uint8_t output;
+
+  if (isnan(value)) {
+    return false;
+  }
+
+  output = (this->mode_ == DemandPi) ? this->pi(value, now) : this->hysteresis(value);
+
+  if (this->started_ == false) {
+    // First value; act on it right away
+    this->started_ = true;
+  } else if ((output == this->output_) || ((now - this->lastChange_) < this->minDwell_)) {
+    return false;
+  }
+
+  this->output_ = output;
+  this->lastChange_ = now;
+  *pOutput = output;
+
+  return true;
+}
+
+uint8_t DemandController::hysteresis(const float value) {
+  uint8_t output = this->output_;
+
+  if (value >= (this->setpoint_ + this->hysteresis_)) {
+    output = this->high_;
+  } else if (value <= (this->setpoint_ - this->hysteresis_)) {
+    output = this->low_;
+  } else if (this->started_ == false) {
+    output = this->low_;  // Inside the band without history
+  }
+
+  return output;
+}
+
+uint8_t DemandController::pi(const float value, const uint32_t now) {
+  const float error = value - this->setpoint_;  // Above setpoint means more ventilation
+  float dt = 0.0f;
+  float output;
+
+  if (this->started_ == true) {
+    dt = (now - this->lastUpdate_) / 1000.0f;
+  }
+  this->lastUpdate_ = now;
+
+  output = this->low_ + (this->kp_ * error) + this->integral_;
+
+  // Only integrate while not saturated (anti-windup)
+  if (((output < this->high_) || (error < 0)) && ((output > this->low_) || (error > 0))) {
+    this->integral_ += this->ki_ * error * dt;
+    output = this->low_ + (this->kp_ * error) + this->integral_;
+  }
+
+  if (output <= this->low_) {
+    return this->low_;
+  } else if (output >= this->high_) {
+    return this->high_;
+  }
+
+  return (uint8_t) lroundf(output);
+}
+
+}  // namespace zehnder
+}  // namespace esphome
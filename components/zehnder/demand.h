@@ -0,0 +1,59 @@
+#ifndef __COMPONENT_ZEHNDER_DEMAND_H__
+#define __COMPONENT_ZEHNDER_DEMAND_H__
+
+#include <stdint.h>
+
+namespace esphome {
+namespace zehnder {
+
+typedef enum {
+  DemandHysteresis,  // Switch between low and high output around the setpoint
+  DemandPi,          // Proportional-integral control between low and high output
+} DemandMode;
+
+/* Maps a sensor value (humidity, CO2) onto a fan output level. The output is in fan speed units: a preset, or a
+ * voltage in 0.1 volt steps. A new output is only returned when it differs from the last one and the previous one
+ * has been held for the minimum dwell time. */
+class DemandController {
+ public:
+  void set_mode(const DemandMode mode) { mode_ = mode; }
+  void set_setpoint(const float setpoint) { setpoint_ = setpoint; }
+  void set_hysteresis(const float hysteresis) { hysteresis_ = hysteresis; }
+  void set_gains(const float kp, const float ki) {
+    kp_ = kp;
+    ki_ = ki;
+  }
+  void set_output_range(const uint8_t low, const uint8_t high) {
+    low_ = low;
+    high_ = high;
+  }
+  void set_min_dwell(const uint32_t ms) { minDwell_ = ms; }
+
+  void dump_config(const char *const tag);
+
+  bool update(const float value, const uint32_t now, uint8_t *const pOutput);
+
+ protected:
+  uint8_t hysteresis(const float value);
+  uint8_t pi(const float value, const uint32_t now);
+
+  DemandMode mode_{DemandHysteresis};
+  float setpoint_{0.0f};
+  float hysteresis_{0.0f};
+  float kp_{0.0f};
+  float ki_{0.0f};
+  uint8_t low_{0};
+  uint8_t high_{0};
+  uint32_t minDwell_{0};
+
+  bool started_{false};
+  uint8_t output_{0};
+  uint32_t lastChange_{0};
+  uint32_t lastUpdate_{0};
+  float integral_{0.0f};
+};
+
+}  // namespace zehnder
+}  // namespace esphome
+
+#endif /* __COMPONENT_ZEHNDER_DEMAND_H__ */
@@ -1,25 +1,318 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import fan
-from esphome.const import CONF_ID, CONF_UPDATE_INTERVAL
+from esphome import automation
+from esphome.components import binary_sensor, fan, sensor, time
+from esphome.const import (
+    CONF_AT,
+    CONF_DAYS_OF_WEEK,
+    CONF_HOUR,
+    CONF_ID,
+    CONF_MINUTE,
+    CONF_MODE,
+    CONF_SENSOR,
+    CONF_SPEED,
+    CONF_TIME_ID,
+    CONF_TRIGGER_ID,
+    CONF_UPDATE_INTERVAL,
+    CONF_VOLTAGE,
+    DEVICE_CLASS_VOLTAGE,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_DECIBEL_MILLIWATT,
+    UNIT_MINUTE,
+    UNIT_PERCENT,
+    UNIT_VOLT,
+)
+from esphome.core import CORE
 
 from esphome.components.nrf905 import nRF905Component
 
 
 DEPENDENCIES = ["nrf905"]
+AUTO_LOAD = ["binary_sensor", "sensor"]
 
 zehnder_ns = cg.esphome_ns.namespace("zehnder")
 ZehnderRF = zehnder_ns.class_("ZehnderRF", fan.FanState)
 
+CommandSuccessTrigger = zehnder_ns.class_(
+    "CommandSuccessTrigger", automation.Trigger.template(cg.uint16, cg.uint8, cg.uint32)
+)
+CommandFailedTrigger = zehnder_ns.class_(
+    "CommandFailedTrigger",
+    automation.Trigger.template(cg.uint16, cg.std_string, cg.uint8, cg.uint32),
+)
+
+SpeedMode = zehnder_ns.enum("SpeedMode")
+SPEED_MODES = {
+    "preset": SpeedMode.SpeedModePreset,
+    "voltage": SpeedMode.SpeedModeVoltage,
+}
+
+RadioPower = zehnder_ns.enum("RadioPower")
+RADIO_POWER_MODES = {
+    "always_on": RadioPower.RadioPowerAlwaysOn,
+    "power_down": RadioPower.RadioPowerDown,
+    "duty_cycle": RadioPower.RadioPowerDutyCycle,
+}
+
+DemandMode = zehnder_ns.enum("DemandMode")
+DEMAND_MODES = {
+    "hysteresis": DemandMode.DemandHysteresis,
+    "pi": DemandMode.DemandPi,
+}
+
 CONF_NRF905 = "nrf905"
+CONF_SPEED_MODE = "speed_mode"
+CONF_DEMAND_CONTROL = "demand_control"
+CONF_SETPOINT = "setpoint"
+CONF_HYSTERESIS = "hysteresis"
+CONF_KP = "kp"
+CONF_KI = "ki"
+CONF_LOW_OUTPUT = "low_output"
+CONF_HIGH_OUTPUT = "high_output"
+CONF_MIN_DWELL = "min_dwell"
+CONF_RAM_USAGE = "ram_usage"
+CONF_RADIO_TASK = "radio_task"
+CONF_NETWORK_DEVICES = "network_devices"
+CONF_ADAPTIVE_TX_POWER = "adaptive_tx_power"
+CONF_MIN_POWER = "min_power"
+CONF_CLEAN_STREAK = "clean_streak"
+CONF_TX_POWER = "tx_power"
+CONF_TIMER = "timer"
+CONF_PUBLISH = "publish"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_HEARTBEAT = "heartbeat"
+CONF_REPEATER = "repeater"
+CONF_MIN_DELAY = "min_delay"
+CONF_MAX_DELAY = "max_delay"
+CONF_ON_COMMAND_SUCCESS = "on_command_success"
+CONF_ON_COMMAND_FAILED = "on_command_failed"
+CONF_PENDING = "pending"
+CONF_SCHEDULE = "schedule"
+CONF_ENTRIES = "entries"
+CONF_RADIO_POWER = "radio_power"
+CONF_RX_WINDOW = "rx_window"
+CONF_RX_PERIOD = "rx_period"
+CONF_RADIO_ON = "radio_on"
+
+# Power up (nRF905 POWER_UP_DELAY, 3ms) and carrier detect time before a receive window or transmit; passed on to
+# the component as ZEHNDER_RADIO_WAKE_LEAD
+RADIO_WAKE_LEAD_MS = 5
+
+UNIT_BYTES = "B"
+
+DEMAND_CONTROL_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_SENSOR): cv.use_id(sensor.Sensor),
+        cv.Optional(CONF_MODE, default="hysteresis"): cv.enum(DEMAND_MODES, lower=True),
+        cv.Required(CONF_SETPOINT): cv.float_,
+        cv.Optional(CONF_HYSTERESIS, default=5.0): cv.positive_float,
+        cv.Optional(CONF_KP, default=0.1): cv.float_,
+        cv.Optional(CONF_KI, default=0.0): cv.float_,
+        cv.Optional(CONF_LOW_OUTPUT, default=1): cv.int_range(min=0, max=100),
+        cv.Optional(CONF_HIGH_OUTPUT, default=3): cv.int_range(min=0, max=100),
+        cv.Optional(CONF_MIN_DWELL, default="5min"): cv.positive_time_period_milliseconds,
+    }
+)
+
+ADAPTIVE_TX_POWER_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_MIN_POWER, default=-10): cv.one_of(-10, -2, 6, 10, int=True),
+        cv.Optional(CONF_CLEAN_STREAK, default=20): cv.int_range(min=1, max=255),
+    }
+)
+
+PUBLISH_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_MIN_INTERVAL, default="1s"): cv.positive_time_period_milliseconds,
+        # Publish unchanged state again this often; 0s disables
+        cv.Optional(CONF_HEARTBEAT, default="10min"): cv.positive_time_period_milliseconds,
+    }
+)
 
-CONFIG_SCHEMA = fan.FAN_SCHEMA.extend(
+REPEATER_SCHEMA = cv.Schema(
     {
-        cv.GenerateID(): cv.declare_id(ZehnderRF),
-        cv.Required(CONF_NRF905): cv.use_id(nRF905Component),
-        cv.Optional(CONF_UPDATE_INTERVAL, default="30s"): cv.update_interval,
+        cv.Optional(CONF_MIN_DELAY, default="20ms"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(max=cv.TimePeriod(milliseconds=500)),
+        ),
+        cv.Optional(CONF_MAX_DELAY, default="120ms"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(max=cv.TimePeriod(milliseconds=500)),
+        ),
     }
-).extend(cv.COMPONENT_SCHEMA)
+)
+
+RADIO_POWER_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_MODE, default="always_on"): cv.enum(RADIO_POWER_MODES, lower=True),
+        # Duty cycle only: listen this long every period
+        cv.Optional(CONF_RX_WINDOW, default="50ms"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=cv.TimePeriod(milliseconds=5), max=cv.TimePeriod(seconds=60)),
+        ),
+        cv.Optional(CONF_RX_PERIOD, default="1s"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(max=cv.TimePeriod(minutes=10)),
+        ),
+    }
+)
+
+# Bit per day, Sunday first, as in the schedule table
+DAYS_OF_WEEK = ["SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT"]
+SCHEDULE_SIZE = 8
+
+SCHEDULE_ENTRY_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_AT): cv.time_of_day,
+        cv.Optional(CONF_DAYS_OF_WEEK, default=DAYS_OF_WEEK): cv.ensure_list(
+            cv.one_of(*DAYS_OF_WEEK, upper=True)
+        ),
+        cv.Required(CONF_SPEED): cv.int_range(min=0, max=100),
+        cv.Optional(CONF_TIMER, default=0): cv.int_range(min=0, max=255),
+    }
+)
+
+SCHEDULE_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_TIME_ID): cv.use_id(time.RealTimeClock),
+        cv.Required(CONF_ENTRIES): cv.All(
+            cv.ensure_list(SCHEDULE_ENTRY_SCHEMA), cv.Length(min=1, max=SCHEDULE_SIZE)
+        ),
+    }
+)
+
+
+def validate_schedule(config):
+    if CONF_SCHEDULE not in config:
+        return config
+    preset = config[CONF_SPEED_MODE] == "preset"
+    for entry in config[CONF_SCHEDULE][CONF_ENTRIES]:
+        if preset and entry[CONF_SPEED] > 4:
+            raise cv.Invalid(f"{CONF_SPEED} must be at most 4 in preset speed mode")
+        if not preset and entry[CONF_TIMER] != 0:
+            raise cv.Invalid(f"{CONF_TIMER} is only supported in preset speed mode")
+    return config
+
+
+def validate_repeater(config):
+    if CONF_REPEATER not in config:
+        return config
+    repeater = config[CONF_REPEATER]
+    if repeater[CONF_MIN_DELAY] > repeater[CONF_MAX_DELAY]:
+        raise cv.Invalid(f"{CONF_MIN_DELAY} must not be above {CONF_MAX_DELAY}")
+    return config
+
+
+def validate_radio_power(config):
+    if CONF_RADIO_POWER not in config:
+        return config
+    radio_power = config[CONF_RADIO_POWER]
+    if radio_power[CONF_MODE] == "always_on":
+        return config
+    if CONF_REPEATER in config:
+        raise cv.Invalid(f"{CONF_REPEATER} needs {CONF_RADIO_POWER} mode always_on")
+    window = radio_power[CONF_RX_WINDOW].total_milliseconds
+    if window + RADIO_WAKE_LEAD_MS >= radio_power[CONF_RX_PERIOD].total_milliseconds:
+        raise cv.Invalid(
+            f"{CONF_RX_PERIOD} must be longer than {CONF_RX_WINDOW} plus {RADIO_WAKE_LEAD_MS}ms"
+        )
+    return config
+
+
+def validate_radio_task(config):
+    # The radio task is a FreeRTOS task; its log lines are handed to the logger by the main loop
+    if config[CONF_RADIO_TASK] and not CORE.is_esp32:
+        raise cv.Invalid(f"{CONF_RADIO_TASK} is only available on ESP32")
+    return config
+
+
+def validate_demand_control(config):
+    if CONF_DEMAND_CONTROL not in config:
+        return config
+    demand = config[CONF_DEMAND_CONTROL]
+    limit = 100 if config[CONF_SPEED_MODE] == "voltage" else 4
+    if demand[CONF_LOW_OUTPUT] > demand[CONF_HIGH_OUTPUT]:
+        raise cv.Invalid(f"{CONF_LOW_OUTPUT} must not be above {CONF_HIGH_OUTPUT}")
+    if demand[CONF_HIGH_OUTPUT] > limit:
+        raise cv.Invalid(f"{CONF_HIGH_OUTPUT} must be at most {limit} in this speed mode")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    fan.FAN_SCHEMA.extend(
+        {
+            cv.GenerateID(): cv.declare_id(ZehnderRF),
+            cv.Required(CONF_NRF905): cv.use_id(nRF905Component),
+            cv.Optional(CONF_UPDATE_INTERVAL, default="30s"): cv.update_interval,
+            cv.Optional(CONF_SPEED_MODE, default="preset"): cv.enum(SPEED_MODES, lower=True),
+            cv.Optional(CONF_VOLTAGE): sensor.sensor_schema(
+                unit_of_measurement=UNIT_VOLT,
+                accuracy_decimals=1,
+                device_class=DEVICE_CLASS_VOLTAGE,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_TIMER): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MINUTE,
+                icon="mdi:timer-outline",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            # On while a state set from the UI is not yet confirmed by the fan
+            cv.Optional(CONF_PENDING): binary_sensor.binary_sensor_schema(
+                icon="mdi:progress-clock",
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_PUBLISH, default={}): PUBLISH_SCHEMA,
+            cv.Optional(CONF_RAM_USAGE): sensor.sensor_schema(
+                unit_of_measurement=UNIT_BYTES,
+                icon="mdi:memory",
+                accuracy_decimals=0,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_NETWORK_DEVICES): sensor.sensor_schema(
+                icon="mdi:access-point-network",
+                accuracy_decimals=0,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            # Lower power costs unsolicited frames: settings changed by a remote show up at the next poll
+            cv.Optional(CONF_RADIO_POWER): RADIO_POWER_SCHEMA,
+            cv.Optional(CONF_RADIO_ON): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                icon="mdi:radio-tower",
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            # Forward frames between devices on our network that cannot reach each other
+            cv.Optional(CONF_REPEATER): REPEATER_SCHEMA,
+            # Runs on the device, also when Home Assistant is not reachable
+            cv.Optional(CONF_SCHEDULE): SCHEDULE_SCHEMA,
+            cv.Optional(CONF_ADAPTIVE_TX_POWER): ADAPTIVE_TX_POWER_SCHEMA,
+            cv.Optional(CONF_TX_POWER): sensor.sensor_schema(
+                unit_of_measurement=UNIT_DECIBEL_MILLIWATT,
+                icon="mdi:signal",
+                accuracy_decimals=0,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_DEMAND_CONTROL): DEMAND_CONTROL_SCHEMA,
+            cv.Optional(CONF_ON_COMMAND_SUCCESS): automation.validate_automation(
+                {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(CommandSuccessTrigger)}
+            ),
+            cv.Optional(CONF_ON_COMMAND_FAILED): automation.validate_automation(
+                {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(CommandFailedTrigger)}
+            ),
+            # Run the radio in its own task; only when the nRF905 is the sole device on its SPI bus
+            cv.Optional(CONF_RADIO_TASK, default=False): cv.boolean,
+        }
+    ).extend(cv.COMPONENT_SCHEMA),
+    validate_demand_control,
+    validate_repeater,
+    validate_radio_power,
+    validate_radio_task,
+    validate_schedule,
+)
 
 
 async def to_code(config):
@@ -29,5 +322,98 @@ async def to_code(config):
 
     nrf905 = await cg.get_variable(config[CONF_NRF905])
     cg.add(var.set_rf(nrf905))
+    cg.add_define("ZEHNDER_RADIO_WAKE_LEAD", RADIO_WAKE_LEAD_MS)
 
     cg.add(var.set_update_interval(config[CONF_UPDATE_INTERVAL]))
+    cg.add(var.set_speed_mode(config[CONF_SPEED_MODE]))
+    cg.add(var.set_radio_task(config[CONF_RADIO_TASK]))
+
+    if CONF_VOLTAGE in config:
+        sens = await sensor.new_sensor(config[CONF_VOLTAGE])
+        cg.add(var.set_voltage_sensor(sens))
+
+    if CONF_TIMER in config:
+        sens = await sensor.new_sensor(config[CONF_TIMER])
+        cg.add(var.set_timer_sensor(sens))
+
+    if CONF_PENDING in config:
+        sens = await binary_sensor.new_binary_sensor(config[CONF_PENDING])
+        cg.add(var.set_pending_sensor(sens))
+
+    publish = config[CONF_PUBLISH]
+    cg.add(var.set_publish_policy(publish[CONF_MIN_INTERVAL], publish[CONF_HEARTBEAT]))
+
+    if CONF_RAM_USAGE in config:
+        sens = await sensor.new_sensor(config[CONF_RAM_USAGE])
+        cg.add(var.set_ram_usage_sensor(sens))
+
+    if CONF_NETWORK_DEVICES in config:
+        sens = await sensor.new_sensor(config[CONF_NETWORK_DEVICES])
+        cg.add(var.set_network_devices_sensor(sens))
+
+    if CONF_REPEATER in config:
+        repeater = config[CONF_REPEATER]
+        cg.add(var.set_repeater(True))
+        cg.add(var.set_repeater_delay(repeater[CONF_MIN_DELAY], repeater[CONF_MAX_DELAY]))
+
+    if CONF_RADIO_POWER in config:
+        radio_power = config[CONF_RADIO_POWER]
+        cg.add(var.set_radio_power(radio_power[CONF_MODE]))
+        cg.add(var.set_rx_window(radio_power[CONF_RX_WINDOW], radio_power[CONF_RX_PERIOD]))
+
+    if CONF_RADIO_ON in config:
+        sens = await sensor.new_sensor(config[CONF_RADIO_ON])
+        cg.add(var.set_radio_on_sensor(sens))
+
+    if CONF_SCHEDULE in config:
+        schedule = config[CONF_SCHEDULE]
+        rtc = await cg.get_variable(schedule[CONF_TIME_ID])
+        cg.add(var.set_time(rtc))
+        for entry in schedule[CONF_ENTRIES]:
+            days = sum(1 << DAYS_OF_WEEK.index(day) for day in entry[CONF_DAYS_OF_WEEK])
+            at = entry[CONF_AT]
+            cg.add(
+                var.add_schedule_entry(
+                    days, at[CONF_HOUR], at[CONF_MINUTE], entry[CONF_SPEED], entry[CONF_TIMER]
+                )
+            )
+
+    if CONF_ADAPTIVE_TX_POWER in config:
+        tx_power = config[CONF_ADAPTIVE_TX_POWER]
+        cg.add(var.set_tx_power_adaptive(True))
+        cg.add(var.set_tx_power_min(tx_power[CONF_MIN_POWER]))
+        cg.add(var.set_tx_power_clean_streak(tx_power[CONF_CLEAN_STREAK]))
+
+    if CONF_TX_POWER in config:
+        sens = await sensor.new_sensor(config[CONF_TX_POWER])
+        cg.add(var.set_tx_power_sensor(sens))
+
+    if CONF_DEMAND_CONTROL in config:
+        demand = config[CONF_DEMAND_CONTROL]
+        sens = await cg.get_variable(demand[CONF_SENSOR])
+        cg.add(var.set_demand_sensor(sens))
+        cg.add(var.set_demand_mode(demand[CONF_MODE]))
+        cg.add(var.set_demand_setpoint(demand[CONF_SETPOINT]))
+        cg.add(var.set_demand_hysteresis(demand[CONF_HYSTERESIS]))
+        cg.add(var.set_demand_gains(demand[CONF_KP], demand[CONF_KI]))
+        cg.add(var.set_demand_output_range(demand[CONF_LOW_OUTPUT], demand[CONF_HIGH_OUTPUT]))
+        cg.add(var.set_demand_min_dwell(demand[CONF_MIN_DWELL]))
+
+    for conf in config.get(CONF_ON_COMMAND_SUCCESS, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(
+            trigger, [(cg.uint16, "id"), (cg.uint8, "retries"), (cg.uint32, "latency")], conf
+        )
+
+    for conf in config.get(CONF_ON_COMMAND_FAILED, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(
+            trigger,
+            [
+                (cg.uint16, "id"),
+                (cg.std_string, "reason"),
+                (cg.uint8, "retries"),
+                (cg.uint32, "latency"),
+            ],
+            conf,
+        )
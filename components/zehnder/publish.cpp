@@ -0,0 +1,52 @@
+#include "publish.h"
+
+namespace esphome {
+namespace zehnder {
+
+bool PublishLimiter::offer(const float value, const uint32_t now) {
+  if ((this->valid_ == true) && (value == this->value_) && (this->pending_ == false)) {
+    ++this->suppressed_;
+    return this->due(now);
+  }
+
+  this->value_ = value;
+  this->valid_ = true;
+  if ((this->published_ > 0) && ((now - this->lastPublish_) < this->minInterval_)) {
+    this->pending_ = true;
+    return false;
+  }
+
+  this->publish(now);
+  return true;
+}
+
+bool PublishLimiter::due(const uint32_t now) {
+  const uint32_t elapsed = now - this->lastPublish_;
+
+  if (this->valid_ == false) {
+    return false;
+  }
+
+  if (((this->pending_ == true) && (elapsed >= this->minInterval_)) ||
+      ((this->heartbeat_ > 0) && (elapsed >= this->heartbeat_))) {
+    this->publish(now);
+    return true;
+  }
+
+  return false;
+}
+
+void PublishLimiter::mark(const float value, const uint32_t now) {
+  this->value_ = value;
+  this->valid_ = true;
+  this->publish(now);
+}
+
+void PublishLimiter::publish(const uint32_t now) {
+  this->pending_ = false;
+  this->lastPublish_ = now;
+  ++this->published_;
+}
+
+}  // namespace zehnder
+}  // namespace esphome
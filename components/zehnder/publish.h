@@ -0,0 +1,42 @@
+#ifndef __COMPONENT_ZEHNDER_PUBLISH_H__
+#define __COMPONENT_ZEHNDER_PUBLISH_H__
+
+#include <stdint.h>
+
+namespace esphome {
+namespace zehnder {
+
+/* Publish-on-change for one entity. A changed value is published right away, unless the previous publish was less
+ * than the minimum interval ago; it is then held back and published by due() once the interval has passed. An
+ * unchanged value is published again every heartbeat so a restarted consumer still gets it. */
+class PublishLimiter {
+ public:
+  void set_min_interval(const uint32_t ms) { minInterval_ = ms; }
+  void set_heartbeat(const uint32_t ms) { heartbeat_ = ms; }  // 0 disables
+
+  bool offer(const float value, const uint32_t now);  // True when the value must be published now
+  bool due(const uint32_t now);                        // True when a held back value or heartbeat is due
+  void mark(const float value, const uint32_t now);    // Value was published outside the limiter
+
+  float get(void) const { return this->value_; }
+  uint32_t getPublished(void) const { return this->published_; }
+  uint32_t getSuppressed(void) const { return this->suppressed_; }
+
+ protected:
+  void publish(const uint32_t now);
+
+  float value_{0.0f};
+  bool valid_{false};    // A value was offered
+  bool pending_{false};  // Changed value held back by the minimum interval
+  uint32_t lastPublish_{0};
+  uint32_t minInterval_{1000};
+  uint32_t heartbeat_{600000};
+
+  uint32_t published_{0};
+  uint32_t suppressed_{0};
+};
+
+}  // namespace zehnder
+}  // namespace esphome
+
+#endif /* __COMPONENT_ZEHNDER_PUBLISH_H__ */
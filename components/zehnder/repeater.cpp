@@ -0,0 +1,78 @@
+#include "repeater.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+#include <string.h>
+
+namespace esphome {
+namespace zehnder {
+
+void Repeater::dump_config(const char *const tag) {
+  ESP_LOGCONFIG(tag, "  Repeater           delay %u - %u ms", this->minDelay_, this->maxDelay_);
+  ESP_LOGCONFIG(tag, "    Forwarded %u, dropped: duplicate %u, TTL %u, queue full %u, stale %u",
+                this->stats_.forwarded, this->stats_.duplicates, this->stats_.expired, this->stats_.overflows,
+                this->stats_.stale);
+}
+
+bool Repeater::offer(const uint8_t *const pFrame, const uint32_t now) {
+  uint8_t key[REPEATER_FRAMESIZE];
+  Entry *pEntry;
+
+  // The TTL changes on every hop; leave it out to recognise a frame forwarded by another repeater
+  (void) memcpy(key, pFrame, REPEATER_FRAMESIZE);
+  key[REPEATER_TTL_OFFSET] = 0;
+  if (this->seen_.isDuplicate(key, REPEATER_FRAMESIZE, now) == true) {
+    ++this->stats_.duplicates;
+    return false;
+  }
+
+  if (pFrame[REPEATER_TTL_OFFSET] <= 1) {
+    ++this->stats_.expired;
+    return false;
+  }
+
+  if (this->count_ >= REPEATER_QUEUE_SIZE) {
+    ++this->stats_.overflows;
+    return false;
+  }
+
+  pEntry = &this->queue_[(this->head_ + this->count_) % REPEATER_QUEUE_SIZE];
+  (void) memcpy(pEntry->frame, pFrame, REPEATER_FRAMESIZE);
+  --pEntry->frame[REPEATER_TTL_OFFSET];
+  pEntry->due = now + this->minDelay_ + (random_uint32() % (this->maxDelay_ - this->minDelay_ + 1));
+  ++this->count_;
+
+  return true;
+}
+
+const uint8_t *Repeater::due(const uint32_t now) {
+  Entry *pEntry;
+
+  while (this->count_ > 0) {
+    pEntry = &this->queue_[this->head_];
+    if ((int32_t) (now - pEntry->due) < 0) {
+      break;
+    }
+    if ((now - pEntry->due) <= REPEATER_MAX_AGE) {
+      return pEntry->frame;
+    }
+
+    // The sender has retried by now; a late copy would only add to the traffic
+    ++this->stats_.stale;
+    this->head_ = (this->head_ + 1) % REPEATER_QUEUE_SIZE;
+    --this->count_;
+  }
+
+  return NULL;
+}
+
+void Repeater::sent(void) {
+  if (this->count_ > 0) {
+    ++this->stats_.forwarded;
+    this->head_ = (this->head_ + 1) % REPEATER_QUEUE_SIZE;
+    --this->count_;
+  }
+}
+
+}  // namespace zehnder
+}  // namespace esphome
@@ -0,0 +1,69 @@
+#ifndef __COMPONENT_ZEHNDER_REPEATER_H__
+#define __COMPONENT_ZEHNDER_REPEATER_H__
+
+#include <stdint.h>
+#include "esphome/components/nrf905/dedup.h"
+
+namespace esphome {
+namespace zehnder {
+
+#define REPEATER_FRAMESIZE 16      // FAN_FRAMESIZE
+#define REPEATER_TTL_OFFSET 4      // Offset of the TTL in a frame
+#define REPEATER_QUEUE_SIZE 4      // Frames waiting for their forwarding delay
+#define REPEATER_SEEN_WINDOW 500   // Copies within this time of the first are duplicates; below FAN_REPLY_TIMEOUT (ms)
+#define REPEATER_MAX_AGE 1000      // Drop a frame not sent this long after its delay ran out (ms)
+
+typedef struct {
+  uint32_t forwarded;   // Frames sent on
+  uint32_t duplicates;  // Dropped; already forwarded, by us or another repeater
+  uint32_t expired;     // Dropped; TTL ran out
+  uint32_t overflows;   // Dropped; queue full
+  uint32_t stale;       // Dropped; radio stayed busy past the maximum age
+} RepeaterStats;
+
+/* Holds received frames that are to be forwarded. Each frame gets a random delay, so that repeaters hearing the
+ * same frame do not all transmit at once. Duplicates are recognised on the frame contents without the TTL, so a
+ * copy already forwarded by another repeater is not sent again. A retry carries the same contents; the window runs
+ * from the first copy and ends before the sender retries, so every retry is forwarded again. */
+class Repeater {
+ public:
+  Repeater() {
+    seen_.set_window(REPEATER_SEEN_WINDOW);
+    seen_.set_refresh(false);
+  }
+
+  void set_delay(const uint16_t min, const uint16_t max) {
+    minDelay_ = min;
+    maxDelay_ = max;
+  }
+
+  void dump_config(const char *const tag);
+
+  bool offer(const uint8_t *const pFrame, const uint32_t now);  // Queue a frame; false when dropped
+  const uint8_t *due(const uint32_t now);                       // Frame to send now, TTL decremented, or NULL
+  void sent(void);                                              // The frame from due() went out
+  uint8_t getCount(void) const { return this->count_; }         // Frames waiting to be forwarded
+
+  const RepeaterStats *getStats(void) const { return &this->stats_; }
+
+ protected:
+  typedef struct {
+    uint8_t frame[REPEATER_FRAMESIZE];
+    uint32_t due;  // Time the forwarding delay runs out (ms)
+  } Entry;
+
+  nrf905::RxDedup seen_;
+  Entry queue_[REPEATER_QUEUE_SIZE];
+  uint8_t head_{0};
+  uint8_t count_{0};
+
+  uint16_t minDelay_{20};
+  uint16_t maxDelay_{120};
+
+  RepeaterStats stats_{};
+};
+
+}  // namespace zehnder
+}  // namespace esphome
+
+#endif /* __COMPONENT_ZEHNDER_REPEATER_H__ */
@@ -0,0 +1,116 @@
+#include "schedule.h"
+#include "esphome/core/log.h"
+
+#include <string.h>
+
+namespace esphome {
+namespace zehnder {
+
+bool Schedule::add(const ScheduleEntry &entry) {
+  uint8_t i;
+
+  for (i = 0; i < SCHEDULE_SIZE; ++i) {
+    if (this->table_.entries[i].days == 0) {
+      this->table_.entries[i] = entry;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Schedule::set(const uint8_t index, const ScheduleEntry &entry) {
+  if ((index >= SCHEDULE_SIZE) || (entry.hour > 23) || (entry.minute > 59)) {
+    return false;
+  }
+
+  this->table_.entries[index] = entry;
+  this->table_.entries[index].days &= SCHEDULE_ALL_DAYS;
+  return true;
+}
+
+const ScheduleEntry *Schedule::get(const uint8_t index) const {
+  return (index < SCHEDULE_SIZE) ? &this->table_.entries[index] : NULL;
+}
+
+uint8_t Schedule::getCount(void) const {
+  uint8_t count = 0;
+  uint8_t i;
+
+  for (i = 0; i < SCHEDULE_SIZE; ++i) {
+    if (this->table_.entries[i].days != 0) {
+      ++count;
+    }
+  }
+
+  return count;
+}
+
+uint32_t Schedule::hash(void) const {
+  const uint8_t *const pData = (const uint8_t *) this->table_.entries;
+  uint32_t hash = 2166136261UL;
+  size_t i;
+
+  // FNV-1a over the entries; the version field is not part of it
+  for (i = 0; i < sizeof(this->table_.entries); ++i) {
+    hash = (hash ^ pData[i]) * 16777619UL;
+  }
+  return hash;
+}
+
+void Schedule::setTable(const ScheduleTable *const pTable) {
+  (void) memcpy(&this->table_, pTable, sizeof(ScheduleTable));
+}
+
+int8_t Schedule::next(const uint8_t dayOfWeek, const uint16_t minuteOfDay, uint16_t *const pMinutes) const {
+  int8_t best = -1;
+  uint16_t bestMinutes = 0;
+  uint8_t i;
+  uint8_t offset;
+
+  for (i = 0; i < SCHEDULE_SIZE; ++i) {
+    const ScheduleEntry *const pEntry = &this->table_.entries[i];
+    const int16_t entryMinute = (pEntry->hour * 60) + pEntry->minute;
+
+    // Today, if still ahead, up to the same day next week
+    for (offset = 0; offset <= 7; ++offset) {
+      const int16_t minutes = (offset * SCHEDULE_MINUTES_DAY) + entryMinute - minuteOfDay;
+
+      if ((minutes > 0) && ((pEntry->days & (1 << ((dayOfWeek + offset) % 7))) != 0)) {
+        if ((best < 0) || ((uint16_t) minutes < bestMinutes)) {
+          best = i;
+          bestMinutes = minutes;
+        }
+        break;
+      }
+    }
+  }
+
+  *pMinutes = bestMinutes;
+  return best;
+}
+
+void Schedule::dump_config(const char *const tag) {
+  static const char dayLetters[] = "SMTWTFS";
+  char days[8];
+  uint8_t i;
+  uint8_t d;
+
+  ESP_LOGCONFIG(tag, "  Schedule           %u entries (version 0x%08X)", this->getCount(), this->table_.version);
+  for (i = 0; i < SCHEDULE_SIZE; ++i) {
+    const ScheduleEntry *const pEntry = &this->table_.entries[i];
+
+    if (pEntry->days == 0) {
+      continue;
+    }
+    for (d = 0; d < 7; ++d) {
+      days[d] = (pEntry->days & (1 << d)) ? dayLetters[d] : '-';
+    }
+    days[7] = '\0';
+    ESP_LOGCONFIG(tag, "    %u: %s %02u:%02u speed %u timer %u", i, days, pEntry->hour, pEntry->minute, pEntry->speed,
+                  pEntry->timer);
+  }
+}
+
+}  // namespace zehnder
+}  // namespace esphome
@@ -0,0 +1,52 @@
+#ifndef __COMPONENT_ZEHNDER_SCHEDULE_H__
+#define __COMPONENT_ZEHNDER_SCHEDULE_H__
+
+#include <stdint.h>
+
+namespace esphome {
+namespace zehnder {
+
+#define SCHEDULE_SIZE 8            // Entries in the schedule table
+#define SCHEDULE_ALL_DAYS 0x7F     // Day mask; bit 0 is Sunday
+#define SCHEDULE_MINUTES_DAY 1440  // Minutes in a day
+
+typedef struct {
+  uint8_t days;    // Day mask, bit 0 = Sunday ... bit 6 = Saturday; 0 = entry unused
+  uint8_t hour;    // Local time of day
+  uint8_t minute;  //
+  uint8_t speed;   // Preset, or voltage in 0.1 volt steps in voltage speed mode
+  uint8_t timer;   // Minutes to run the preset before the fan falls back; 0 = no timer
+} ScheduleEntry;
+
+typedef struct {
+  uint32_t version;  // Hash of the table from the configuration it was derived from
+  ScheduleEntry entries[SCHEDULE_SIZE];
+} ScheduleTable;
+
+/* Time-of-day and weekday rules. Only the next due entry is looked up, on demand; the owner keeps its due time and
+ * compares against that, so a check costs one comparison until an entry fires. */
+class Schedule {
+ public:
+  bool add(const ScheduleEntry &entry);  // First free slot
+  bool set(const uint8_t index, const ScheduleEntry &entry);
+  const ScheduleEntry *get(const uint8_t index) const;
+  uint8_t getCount(void) const;
+
+  uint32_t hash(void) const;
+  const ScheduleTable *getTable(void) const { return &this->table_; }
+  void setTable(const ScheduleTable *const pTable);
+
+  // Index of the entry due first strictly after the given minute (day 0 = Sunday), or -1; pMinutes gets the
+  // minutes until then
+  int8_t next(const uint8_t dayOfWeek, const uint16_t minuteOfDay, uint16_t *const pMinutes) const;
+
+  void dump_config(const char *const tag);
+
+ protected:
+  ScheduleTable table_{};
+};
+
+}  // namespace zehnder
+}  // namespace esphome
+
+#endif /* __COMPONENT_ZEHNDER_SCHEDULE_H__ */
@@ -0,0 +1,51 @@
+#ifndef __COMPONENT_ZEHNDER_TRANSACTION_H__
+#define __COMPONENT_ZEHNDER_TRANSACTION_H__
+
+#include <stdint.h>
+
+namespace esphome {
+namespace zehnder {
+
+/*
+ * Protothread style transactions.
+ *
+ * A flow is a function that is called again on every event (loop tick, received frame, receive timeout) and
+ * resumes at the wait point it returned from. This lets a flow read as "send, wait for reply, send ack" without a
+ * state per step. The resume point is a line number, so a flow costs only the state it keeps in its transaction.
+ *
+ * Rules:
+ *  - Local variables do not survive a wait; keep state in the transaction.
+ *  - Do not use switch statements around a wait point.
+ *  - Only one wait per source line.
+ */
+
+typedef enum { TransactionWaiting, TransactionDone } TransactionStatus;
+
+#define TR_BEGIN(pTr) \
+  switch ((pTr)->line) { \
+    case 0:
+
+#define TR_WAIT_UNTIL(pTr, condition) \
+  do { \
+    (pTr)->line = __LINE__; \
+    case __LINE__: \
+      if (!(condition)) { \
+        return TransactionWaiting; \
+      } \
+  } while (0)
+
+#define TR_EXIT(pTr) \
+  do { \
+    (pTr)->line = 0; \
+    return TransactionDone; \
+  } while (0)
+
+#define TR_END(pTr) \
+  } \
+  (pTr)->line = 0; \
+  return TransactionDone;
+
+}  // namespace zehnder
+}  // namespace esphome
+
+#endif /* __COMPONENT_ZEHNDER_TRANSACTION_H__ */
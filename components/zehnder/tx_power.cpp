@@ -0,0 +1,135 @@
+#include "tx_power.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace zehnder {
+
+static const int8_t powerLevels[] = {-10, -2, 6, 10};  // Supported by the nRF905 (dBm)
+
+#define TX_POWER_LEVELS (sizeof(powerLevels) / sizeof(powerLevels[0]))
+
+int8_t TxPowerController::levelToPower(const uint8_t level) {
+  return powerLevels[(level < TX_POWER_LEVELS) ? level : TX_POWER_LEVELS - 1];
+}
+
+uint8_t TxPowerController::powerToLevel(const int8_t power) {
+  uint8_t level = 0;
+
+  // Lowest level that is at least the requested power
+  while ((level < (TX_POWER_LEVELS - 1)) && (powerLevels[level] < power)) {
+    ++level;
+  }
+
+  return level;
+}
+
+void TxPowerController::dump_config(const char *const tag, const uint32_t now) {
+  const TxPowerChange *pChange;
+  uint8_t i;
+
+  ESP_LOGCONFIG(tag, "  Adaptive TX power  min %d dBm, step down after %u clean exchanges",
+                levelToPower(this->minLevel_), this->cleanStreak_);
+  for (i = 0; i < this->peerCount_; ++i) {
+    ESP_LOGCONFIG(tag, "    Peer 0x%02X/0x%02X  %d dBm, %u exchanges, %u retries, %u misses", this->peers_[i].type,
+                  this->peers_[i].id, levelToPower(this->peers_[i].level), this->peers_[i].exchanges,
+                  this->peers_[i].retries, this->peers_[i].misses);
+  }
+  for (i = 0; (pChange = this->getHistory(i)) != NULL; ++i) {
+    ESP_LOGCONFIG(tag, "    %u s ago: peer 0x%02X/0x%02X -> %d dBm", (now - pChange->time) / 1000, pChange->type,
+                  pChange->id, pChange->power);
+  }
+}
+
+int8_t TxPowerController::getPower(const uint8_t type, const uint8_t id, const uint8_t retry) {
+  const Peer *const pPeer = this->findPeer(type, id, false);
+
+  // One level up for every retry; levelToPower() caps at full power
+  return (pPeer != NULL) ? levelToPower(pPeer->level + retry) : TX_POWER_MAX;
+}
+
+bool TxPowerController::report(const uint8_t type, const uint8_t id, const uint8_t retries, const bool success,
+                               const uint32_t now) {
+  Peer *const pPeer = this->findPeer(type, id, true);
+  const uint8_t level = pPeer->level;
+
+  ++pPeer->exchanges;
+  pPeer->retries += retries;
+
+  if (success == false) {
+    // Missed; back to full power right away
+    ++pPeer->misses;
+    pPeer->streak = 0;
+    this->setLevel(pPeer, TX_POWER_LEVELS - 1, now);
+  } else if (retries >= TX_POWER_STEP_UP) {
+    // Marginal
+    pPeer->streak = 0;
+    if (pPeer->level < (TX_POWER_LEVELS - 1)) {
+      this->setLevel(pPeer, pPeer->level + 1, now);
+    }
+  } else if (retries > 0) {
+    pPeer->streak = 0;
+  } else if (++pPeer->streak >= this->cleanStreak_) {
+    pPeer->streak = 0;
+    if (pPeer->level > this->minLevel_) {
+      this->setLevel(pPeer, pPeer->level - 1, now);
+    }
+  }
+
+  return pPeer->level != level;
+}
+
+const TxPowerChange *TxPowerController::getHistory(const uint8_t index) const {
+  if (index >= this->historyCount_) {
+    return NULL;
+  }
+
+  return &this->history_[(this->historyNext_ + TX_POWER_HISTORY - this->historyCount_ + index) % TX_POWER_HISTORY];
+}
+
+TxPowerController::Peer *TxPowerController::findPeer(const uint8_t type, const uint8_t id, const bool create) {
+  Peer *pPeer = NULL;
+  uint8_t i;
+
+  for (i = 0; (i < this->peerCount_) && (pPeer == NULL); ++i) {
+    if ((this->peers_[i].type == type) && (this->peers_[i].id == id)) {
+      pPeer = &this->peers_[i];
+    }
+  }
+
+  if ((pPeer == NULL) && (create == true)) {
+    // Table full: reuse the last entry; in practice the only peer is the main unit
+    pPeer = &this->peers_[(this->peerCount_ < TX_POWER_PEERS) ? this->peerCount_++ : TX_POWER_PEERS - 1];
+    pPeer->type = type;
+    pPeer->id = id;
+    pPeer->level = TX_POWER_LEVELS - 1;
+    pPeer->streak = 0;
+    pPeer->exchanges = 0;
+    pPeer->retries = 0;
+    pPeer->misses = 0;
+  }
+
+  return pPeer;
+}
+
+void TxPowerController::setLevel(Peer *const pPeer, const uint8_t level, const uint32_t now) {
+  TxPowerChange *pChange;
+
+  if (level == pPeer->level) {
+    return;
+  }
+  pPeer->level = level;
+
+  pChange = &this->history_[this->historyNext_];
+  pChange->time = now;
+  pChange->type = pPeer->type;
+  pChange->id = pPeer->id;
+  pChange->power = levelToPower(level);
+
+  this->historyNext_ = (this->historyNext_ + 1) % TX_POWER_HISTORY;
+  if (this->historyCount_ < TX_POWER_HISTORY) {
+    ++this->historyCount_;
+  }
+}
+
+}  // namespace zehnder
+}  // namespace esphome
@@ -0,0 +1,69 @@
+#ifndef __COMPONENT_ZEHNDER_TX_POWER_H__
+#define __COMPONENT_ZEHNDER_TX_POWER_H__
+
+#include <stdint.h>
+
+namespace esphome {
+namespace zehnder {
+
+#define TX_POWER_PEERS 4     // Peers with their own power level
+#define TX_POWER_HISTORY 8   // Power changes kept for diagnostics
+#define TX_POWER_MAX 10      // dBm; used for broadcasts, unknown peers and after a miss
+#define TX_POWER_STEP_UP 2   // Retries in one exchange that step the power up
+
+typedef struct {
+  uint32_t time;  // Time of the change (ms)
+  uint8_t type;   // Peer device type
+  uint8_t id;     // Peer device ID
+  int8_t power;   // New power (dBm)
+} TxPowerChange;
+
+/* Closed-loop transmit power per peer. Starts at full power; every exchange reports the number of retries it took,
+ * or a miss when no reply came. After a run of clean exchanges (no retries) the power steps down one level, down to
+ * the configured minimum. A marginal exchange steps it up one level, a miss goes straight back to full power.
+ * Within an exchange every retry goes out one level above the previous try, so a reply lost to the reduced power is
+ * not retried at that same power. */
+class TxPowerController {
+ public:
+  void set_min_power(const int8_t power) { minLevel_ = powerToLevel(power); }
+  void set_clean_streak(const uint8_t streak) { cleanStreak_ = streak; }
+
+  void dump_config(const char *const tag, const uint32_t now);
+
+  int8_t getPower(const uint8_t type, const uint8_t id, const uint8_t retry = 0);
+  bool report(const uint8_t type, const uint8_t id, const uint8_t retries, const bool success, const uint32_t now);
+
+  const TxPowerChange *getHistory(const uint8_t index) const;  // Oldest first; NULL past the end
+
+  static int8_t levelToPower(const uint8_t level);
+  static uint8_t powerToLevel(const int8_t power);
+
+ protected:
+  typedef struct {
+    uint8_t type;
+    uint8_t id;
+    uint8_t level;    // Index in the power table
+    uint8_t streak;   // Clean exchanges since the last change
+    uint32_t exchanges;
+    uint32_t retries;
+    uint32_t misses;
+  } Peer;
+
+  Peer *findPeer(const uint8_t type, const uint8_t id, const bool create);
+  void setLevel(Peer *const pPeer, const uint8_t level, const uint32_t now);
+
+  uint8_t minLevel_{0};
+  uint8_t cleanStreak_{20};
+
+  Peer peers_[TX_POWER_PEERS];
+  uint8_t peerCount_{0};
+
+  TxPowerChange history_[TX_POWER_HISTORY];
+  uint8_t historyCount_{0};
+  uint8_t historyNext_{0};
+};
+
+}  // namespace zehnder
+}  // namespace esphome
+
+#endif /* __COMPONENT_ZEHNDER_TX_POWER_H__ */
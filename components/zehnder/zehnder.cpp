@@ -1,12 +1,14 @@
 #include "zehnder.h"
 #include "esphome/core/log.h"
 #include "esphome/core/application.h"
+#include "esphome/components/nrf905/radio_log.h"
+
+#include <algorithm>
+#include <stddef.h>
 
 namespace esphome {
 namespace zehnder {
 
-#define MAX_TRANSMIT_TIME 2000
-
 static const char *const TAG = "zehnder";
 
 typedef struct __attribute__((packed)) {
@@ -31,6 +33,10 @@ typedef struct __attribute__((packed)) {
   uint8_t speed;
 } RfPayloadFanSetSpeed;
 
+typedef struct __attribute__((packed)) {
+  uint8_t voltage;
+} RfPayloadFanSetVoltage;
+
 typedef struct __attribute__((packed)) {
   uint8_t speed;
   uint8_t timer;
@@ -47,6 +53,7 @@ typedef struct __attribute__((packed)) {
 
   union {
     uint8_t parameters[9];                           // 0x07 - 0x0F Depends on command
+    RfPayloadFanSetVoltage setVoltage;               // Command 0x01
     RfPayloadFanSetSpeed setSpeed;                   // Command 0x02
     RfPayloadFanSetTimer setTimer;                   // Command 0x03
     RfPayloadNetworkJoinRequest networkJoinRequest;  // Command 0x04
@@ -56,6 +63,29 @@ typedef struct __attribute__((packed)) {
   } payload;
 } RfFrame;
 
+static_assert(sizeof(RfFrame) == REPEATER_FRAMESIZE, "Repeater frame size");
+static_assert(offsetof(RfFrame, ttl) == REPEATER_TTL_OFFSET, "Repeater TTL offset");
+static_assert(RADIO_WAKE_LEAD > POWER_UP_DELAY, "Wake lead must cover the power up delay");
+
+// Frame received by the transaction; only valid directly after TR_AWAIT_REPLY
+#define TR_REPLY(pTr) ((const RfFrame *) (pTr)->pRx)
+
+// Send the frame in _txFrame as soon as the RF layer can take it
+#define TR_SEND(pTr, rxRetries) \
+  do { \
+    TR_WAIT_UNTIL(pTr, this->rfCanSend()); \
+    this->transactionSend(pTr, rxRetries); \
+  } while (0)
+
+// Wait for a received frame for which 'match' holds, or until the RF layer runs out of retries
+#define TR_AWAIT_REPLY(pTr, match) \
+  do { \
+    TR_WAIT_UNTIL(pTr, ((pTr)->rxTimeout == true) || (((pTr)->pRx != NULL) && (match))); \
+    if ((pTr)->rxTimeout == false) { \
+      this->rfComplete(); \
+    } \
+  } while (0)
+
 ZehnderRF::ZehnderRF(void) {}
 
 fan::FanTraits ZehnderRF::get_traits() { return fan::FanTraits(false, true, false, this->speed_count_); }
@@ -70,24 +100,32 @@ void ZehnderRF::control(const fan::FanCall &call) {
     ESP_LOGD(TAG, "Control has speed: %u", this->speed);
   }
 
-  switch (this->state_) {
-    case StateIdle:
-      // Set speed
-      this->setSpeed(this->state ? this->speed : 0x00, 0);
-
-      this->lastFanQuery_ = millis();  // Update time
-      break;
-
-    default:
-      break;
+  // Set speed; the requested state is shown right away, pending until the fan reports its settings
+  if (this->speedMode_ == SpeedModeVoltage) {
+    this->setPending(this->setVoltage(this->state ? this->speed : 0x00));
+  } else {
+    this->setPending(this->setSpeed(this->state ? this->speed : 0x00, 0));
   }
 
+  // Direct feedback to the caller; the limiter only learns the new state
   this->publish_state();
+  this->publish_[PublishFan].mark(this->fanStateKey(), this->clock_->millis());
+}
+
+void ZehnderRF::set_publish_policy(const uint32_t minInterval, const uint32_t heartbeat) {
+  uint8_t i;
+
+  for (i = 0; i < PublishNrOf; ++i) {
+    this->publish_[i].set_min_interval(minInterval);
+    this->publish_[i].set_heartbeat(heartbeat);
+  }
 }
 
 void ZehnderRF::setup() {
   ESP_LOGCONFIG(TAG, "ZEHNDER '%s':", this->get_name().c_str());
 
+  this->startupTime_ = this->clock_->millis();
+
   // Clear config
   memset(&this->config_, 0, sizeof(Config));
 
@@ -97,48 +135,41 @@ void ZehnderRF::setup() {
     ESP_LOGD(TAG, "Config load ok");
   }
 
-  // Set nRF905 config
-  nrf905::Config rfConfig;
-  rfConfig = this->rf_->getConfig();
-
-  rfConfig.band = true;
-  rfConfig.channel = 118;
-
-  // // CRC 16
-  rfConfig.crc_enable = true;
-  rfConfig.crc_bits = 16;
-
-  // // TX power 10
-  rfConfig.tx_power = 10;
+  this->scheduleLoad();
 
-  // // RX power normal
-  rfConfig.rx_power = nrf905::PowerNormal;
+  // Radio registers come from the nrf905 YAML options, written once by its setup
+  this->publishSensor(this->txPowerSensor_, PublishTxPower, this->rf_->getConfig().tx_power);
 
-  rfConfig.rx_address = 0x89816EA9;  // ZEHNDER_NETWORK_LINK_ID;
-  rfConfig.rx_address_width = 4;
-  rfConfig.rx_payload_width = 16;
-
-  rfConfig.tx_address_width = 4;
-  rfConfig.tx_payload_width = 16;
-
-  rfConfig.xtal_frequency = 16000000;  // defaults for now
-  rfConfig.clkOutFrequency = nrf905::ClkOut500000;
-  rfConfig.clkOutEnable = false;
-
-  // Write config back
-  this->rf_->updateConfig(&rfConfig);
-  this->rf_->writeTxAddress(0x89816EA9);
-
-  this->speed_count_ = 4;
+  this->speed_count_ = (this->speedMode_ == SpeedModeVoltage) ? FAN_VOLTAGE_MAX : 4;
 
   this->rf_->setOnTxReady([this](void) {
     ESP_LOGD(TAG, "Tx Ready");
+    if (this->txRecovery_ != TxRecoveryNone) {
+      TxRecoveryStats *const pStats = &this->txRecoveryStats_;
+
+      pStats->lastRecoveryTime = this->clock_->millis() - this->txRecoveryStartTime_;
+      if (pStats->lastRecoveryTime > pStats->maxRecoveryTime) {
+        pStats->maxRecoveryTime = pStats->lastRecoveryTime;
+      }
+      ++pStats->recovered;
+      ESP_LOGI(TAG, "TX recovered at tier %u after %u ms", this->txRecovery_, pStats->lastRecoveryTime);
+
+      this->txRecovery_ = TxRecoveryNone;
+    }
     if (this->rfState_ == RfStateTxBusy) {
       if (this->retries_ >= 0) {
-        this->msgSendTime_ = millis();
+        this->msgSendTime_ = this->clock_->millis();
         this->rfState_ = RfStateRxWait;
+      } else if (this->txStaged_ == true) {
+        // Next frame was staged while this one was on air; start it now instead of on a later loop
+        this->txStaged_ = false;
+        this->rfLoad(this->txStagedFrame_, this->txStagedRetries_);
+        this->rfHandler();
       } else {
+        // Let a waiting flow send right away
         this->rfState_ = RfStateIdle;
+        this->transactionRun();
+        this->rfHandler();
       }
     }
   });
@@ -147,21 +178,200 @@ void ZehnderRF::setup() {
     ESP_LOGV(TAG, "Received frame");
     this->rfHandleReceived(pData, dataLength);
   });
+
+  if (this->demandSensor_ != NULL) {
+    this->demandSensor_->add_on_state_callback([this](const float value) { this->demandUpdate(value); });
+  }
+
+  // Held back changes, heartbeats and the RAM sensor; publishes when the stack peak grew
+  this->set_interval("publish", PUBLISH_CHECK_INTERVAL, [this](void) {
+    this->publishSensor(this->ramUsageSensor_, PublishRamUsage, this->getRamUsage());
+    this->publishDue();
+    this->pendingCheck();
+  });
+  if (this->radioOnSensor_ != NULL) {
+    this->set_interval("radio_on", RADIO_ON_INTERVAL, [this](void) { this->radioOnPublish(); });
+  }
+#ifdef USE_TIME
+  if (this->time_ != NULL) {
+    this->set_interval("schedule", SCHEDULE_CHECK_INTERVAL, [this](void) { this->scheduleRun(); });
+  }
+#endif
+
+  // Start the radio task once every component is set up, so it never touches the radio before the SPI bus
+  if (this->radioTask_ == true) {
+    this->defer([this](void) { this->radioTaskStart(); });
+  }
 }
 
 void ZehnderRF::dump_config(void) {
+  RadioCommand command;
+
   ESP_LOGCONFIG(TAG, "Zehnder Fan config:");
   ESP_LOGCONFIG(TAG, "  Polling interval   %u", this->interval_);
+  ESP_LOGCONFIG(TAG, "  Speed mode         %s", this->speedMode_ == SpeedModeVoltage ? "voltage" : "preset");
+  if (this->radioTask_ == true) {
+    ESP_LOGCONFIG(TAG, "  Radio task         yes, every %u ms", nrf905::RadioThread::roundPeriod(RADIO_TASK_PERIOD));
+  } else {
+    ESP_LOGCONFIG(TAG, "  Radio task         no");
+  }
+  LOG_SENSOR("  ", "Voltage", this->voltageSensor_);
+  LOG_SENSOR("  ", "Timer", this->timerSensor_);
+  LOG_BINARY_SENSOR("  ", "Pending", this->pendingSensor_);
+  ESP_LOGCONFIG(TAG, "  Publishes          fan %u (unchanged %u), sensors %u (unchanged %u)",
+                this->publish_[PublishFan].getPublished(), this->publish_[PublishFan].getSuppressed(),
+                this->publishedSensors(false), this->publishedSensors(true));
+  if (this->demandSensor_ != NULL) {
+    this->demand_.dump_config(TAG);
+  }
+  ESP_LOGCONFIG(TAG, "  RAM                %u bytes (object %u, radio %u, hex buffer %u, stack peak %u in %s)",
+                this->getRamUsage(), sizeof(ZehnderRF), sizeof(nrf905::nRF905), NRF905_HEX_STR_SIZE,
+                nrf905::memoryMeter.getStackPeak(),
+                nrf905::memoryMeter.isRadioTask() ? "radio task" : "main loop");
+  if (nrf905::memoryMeter.isRadioTask() == true) {
+    ESP_LOGCONFIG(TAG, "  Heap drops in loop not measured, main loop runs concurrently with the radio task");
+  } else {
+    ESP_LOGCONFIG(TAG, "  Heap drops in loop %u (%u bytes)", nrf905::memoryMeter.getHeapDrops(),
+                  nrf905::memoryMeter.getHeapDropBytes());
+  }
+  LOG_SENSOR("  ", "RAM usage", this->ramUsageSensor_);
   ESP_LOGCONFIG(TAG, "  Fan networkId      0x%08X", this->config_.fan_networkId);
   ESP_LOGCONFIG(TAG, "  Fan my device type 0x%02X", this->config_.fan_my_device_type);
   ESP_LOGCONFIG(TAG, "  Fan my device id   0x%02X", this->config_.fan_my_device_id);
   ESP_LOGCONFIG(TAG, "  Fan main_unit type 0x%02X", this->config_.fan_main_unit_type);
   ESP_LOGCONFIG(TAG, "  Fan main unit id   0x%02X", this->config_.fan_main_unit_id);
+  ESP_LOGCONFIG(TAG, "  Pairing attempts   %u (timeouts %u, last run %u ms)", this->pairingStats_.attempts,
+                this->pairingStats_.timeouts, this->pairingStats_.lastDuration);
+  ESP_LOGCONFIG(TAG, "  ID conflicts       %u", this->pairingStats_.idConflicts);
+  if (this->radioTask_ == false) {
+    this->dumpTables(this->inventory_, this->inventoryCount_, &this->txPower_);
+  } else if (this->snapshotPending_ == false) {
+    // The radio task writes the tables; it sends a copy, logged when it arrives
+    command.type = RadioCommandSnapshot;
+    this->snapshotPending_ = this->radioCommands_.push(command);
+  }
+  LOG_SENSOR("  ", "Network devices", this->networkDevicesSensor_);
+  if (this->schedule_.getCount() > 0) {
+    this->schedule_.dump_config(TAG);
+  }
+  if (this->repeaterEnabled_ == true) {
+    this->repeater_.dump_config(TAG);
+  }
+  LOG_SENSOR("  ", "TX power", this->txPowerSensor_);
+  if (this->radioPower_ == RadioPowerDutyCycle) {
+    ESP_LOGCONFIG(TAG, "  Radio power        duty cycle, %u ms window every %u ms (wake lead %u ms)", this->rxWindow_,
+                  this->rxPeriod_, RADIO_WAKE_LEAD);
+  } else {
+    ESP_LOGCONFIG(TAG, "  Radio power        %s",
+                  (this->radioPower_ == RadioPowerDown) ? "power down between transactions" : "always on");
+  }
+  LOG_SENSOR("  ", "Radio on", this->radioOnSensor_);
+  ESP_LOGCONFIG(TAG, "  Transactions       %u slots x %u bytes", TRANSACTION_SLOTS, sizeof(Transaction));
+  ESP_LOGCONFIG(TAG, "  Commands           %u ok (slowest %u ms), %u timeout, %u replaced, %u rejected",
+                this->commandStats_.success, this->commandStats_.maxLatency, this->commandStats_.timeouts,
+                this->commandStats_.replaced, this->commandStats_.rejected);
+  ESP_LOGCONFIG(TAG, "  Lost outcomes      %u dropped on a full event queue, %u timed out after %u s",
+                this->outcomeDrops_, this->commandStats_.lost, COMMAND_OUTCOME_TIMEOUT / 1000);
+  ESP_LOGCONFIG(TAG, "  Bus budget         %u transfers, %u bytes, %u pin writes per frame (exceeded %u x)",
+                BUS_BUDGET_TRANSFERS, BUS_BUDGET_BYTES, BUS_BUDGET_PIN_WRITES, this->busOverruns_);
+  ESP_LOGCONFIG(TAG, "  TX stalls          %u", this->txRecoveryStats_.stalls);
+  ESP_LOGCONFIG(TAG, "  TX recoveries      %u (toggle %u, rewrite %u, power cycle %u, failed %u)",
+                this->txRecoveryStats_.recovered, this->txRecoveryStats_.modeToggles,
+                this->txRecoveryStats_.configRewrites, this->txRecoveryStats_.powerCycles,
+                this->txRecoveryStats_.failures);
+  ESP_LOGCONFIG(TAG, "  TX recovery time   last %u ms, max %u ms", this->txRecoveryStats_.lastRecoveryTime,
+                this->txRecoveryStats_.maxRecoveryTime);
 }
 
 void ZehnderRF::loop(void) {
-  uint8_t deviceId;
-  nrf905::Config rfConfig;
+  // The radio side only runs while something is in flight; new work or its next deadline wakes it. The deadline is a
+  // compare against the clock, no scheduler item per sleep, so an idle loop does not touch the heap.
+  if ((this->radioTask_ == false) && (this->radioAwake() == true)) {
+    this->radioStep();
+  }
+
+  this->radioEvents();  // Command outcomes go through the queue in both modes
+}
+
+void ZehnderRF::radioTaskStart(void) {
+  this->rf_->setRunInTask(true);
+  nrf905::memoryMeter.setRadioTask(true);
+  if (this->radioThread_.start(
+          "zehnder_rf",
+          [this](void) {
+            this->radioCommands();
+            this->radioSnapshot();
+            this->rf_->process();
+            if (this->radioAwake() == true) {
+              this->radioStep();
+            }
+          },
+          RADIO_TASK_PERIOD) == false) {
+    ESP_LOGE(TAG, "Failed to start radio task, running radio in main loop");
+    this->rf_->setRunInTask(false);
+    nrf905::memoryMeter.setRadioTask(false);
+    this->radioTask_ = false;
+    this->radioCommands();
+  }
+}
+
+void ZehnderRF::radioSleep(const uint32_t time) {
+  this->radioIdle_ = true;
+  this->radioSleepStart_ = this->clock_->millis();
+  this->radioSleepTime_ = time;
+}
+
+bool ZehnderRF::radioAwake(void) {
+  if ((this->radioIdle_ == true) && ((this->clock_->millis() - this->radioSleepStart_) >= this->radioSleepTime_)) {
+    this->radioIdle_ = false;
+  }
+
+  return this->radioIdle_ == false;
+}
+
+uint32_t ZehnderRF::radioIdleTime(void) {
+  const uint32_t now = this->clock_->millis();
+  uint32_t idle = UINT32_MAX;
+
+  if ((this->transactionCount_ > 0) || (this->rfState_ != RfStateIdle) || (this->txStaged_ == true) ||
+      (this->repeater_.getCount() > 0)) {
+    return 0;
+  }
+
+  switch (this->state_) {
+    case StatePairingTimeout:
+      idle = deadlineRemaining(now, this->pairingTimeoutTime_, PAIRING_RETRY_INTERVAL);
+      break;
+
+    case StateIdle:
+      idle = deadlineRemaining(now, this->lastFanQuery_, this->pollInterval());
+      break;
+
+    default:
+      // Startup and pairing are short; keep running
+      return 0;
+  }
+
+  // Power policy switches the radio on and off on its own clock
+  if (this->radioPower_ == RadioPowerDutyCycle) {
+    if (this->rf_->getMode() == nrf905::PowerDown) {
+      idle = std::min(idle,
+                      deadlineRemaining(now, this->powerTime_, this->rxPeriod_ - this->rxWindow_ - RADIO_WAKE_LEAD));
+    } else {
+      idle = std::min(idle, deadlineRemaining(now, this->powerTime_, RADIO_WAKE_LEAD + this->rxWindow_));
+    }
+  } else if ((this->radioPower_ == RadioPowerDown) && (this->rf_->getMode() != nrf905::PowerDown)) {
+    idle = 0;
+  }
+
+  return idle;
+}
+
+void ZehnderRF::radioStep(void) {
+  uint32_t idle;
+
+  MEMORY_STACK_BEGIN();
+  nrf905::memoryMeter.heapBegin();
 
   // Run RF handler
   this->rfHandler();
@@ -169,477 +379,1493 @@ void ZehnderRF::loop(void) {
   switch (this->state_) {
     case StateStartup:
       // Wait until started up
-      if (millis() > 15000) {
+      if (deadlinePassed(this->clock_->millis(), this->startupTime_, 15000) == true) {
         // Discovery?
-        if ((this->config_.fan_networkId == 0x00000000) || (this->config_.fan_my_device_type == 0) ||
-            (this->config_.fan_my_device_id == 0) || (this->config_.fan_main_unit_type == 0) ||
-            (this->config_.fan_main_unit_id == 0)) {
+        if (this->isPaired() == false) {
           ESP_LOGD(TAG, "Invalid config, start paring");
 
           this->state_ = StateStartDiscovery;
         } else {
           ESP_LOGD(TAG, "Config data valid, start polling");
 
-          rfConfig = this->rf_->getConfig();
-          rfConfig.rx_address = this->config_.fan_networkId;
-          this->rf_->updateConfig(&rfConfig);
-          this->rf_->writeTxAddress(this->config_.fan_networkId);
+          this->setNetwork(this->config_.fan_networkId);
+          this->state_ = StateIdle;
 
-          // Start with query
+          // Start with query, then learn who else is on the network
           this->queryDevice();
+          this->inventoryStart();
         }
       }
       break;
 
     case StateStartDiscovery:
-      deviceId = this->createDeviceID();
-      this->discoveryStart(deviceId);
-
-      // For now just set TX
+      this->discoveryStart();
       break;
 
-    case StateIdle:
-      if (newSetting == true) {
-        this->setSpeed(newSpeed, newTimer);
-      } else {
-        if ((millis() - this->lastFanQuery_) > this->interval_) {
-          this->queryDevice();
-        }
+    case StatePairingTimeout:
+      if (deadlinePassed(this->clock_->millis(), this->pairingTimeoutTime_, PAIRING_RETRY_INTERVAL) == true) {
+        this->state_ = StateStartDiscovery;
       }
       break;
 
-    case StateWaitSetSpeedConfirm:
-      if (this->rfState_ == RfStateIdle) {
-        // When done, return to idle
-        this->state_ = StateIdle;
+    case StateIdle:
+      if ((this->transactionCount_ == 0) &&
+          (deadlinePassed(this->clock_->millis(), this->lastFanQuery_, this->pollInterval()) == true)) {
+        this->queryDevice();
       }
+      break;
 
     default:
       break;
   }
-}
 
-void ZehnderRF::rfHandleReceived(const uint8_t *const pData, const uint8_t dataLength) {
-  const RfFrame *const pResponse = (RfFrame *) pData;
-  RfFrame *const pTxFrame = (RfFrame *) this->_txFrame;  // frame helper
-  nrf905::Config rfConfig;
+  // Resume transactions waiting for the RF layer
+  this->transactionRun();
 
-  ESP_LOGD(TAG, "Current state: 0x%02X", this->state_);
-  switch (this->state_) {
-    case StateDiscoveryWaitForLinkRequest:
-      ESP_LOGD(TAG, "DiscoverStateWaitForLinkRequest");
-      switch (pResponse->command) {
-        case FAN_NETWORK_JOIN_OPEN:  // Received linking request from main unit
-          ESP_LOGD(TAG, "Discovery: Found unit type 0x%02X (%s) with ID 0x%02X on network 0x%08X", pResponse->tx_type,
-                   pResponse->tx_type == FAN_TYPE_MAIN_UNIT ? "Main" : "?", pResponse->tx_id,
-                   pResponse->payload.networkJoinOpen.networkId);
-
-          this->rfComplete();
-
-          (void) memset(this->_txFrame, 0, FAN_FRAMESIZE);  // Clear frame data
-
-          // Found a main unit, so send a join request
-          pTxFrame->rx_type = FAN_TYPE_MAIN_UNIT;  // Set type to main unit
-          pTxFrame->rx_id = pResponse->tx_id;      // Set ID to the ID of the main unit
-          pTxFrame->tx_type = this->config_.fan_my_device_type;
-          pTxFrame->tx_id = this->config_.fan_my_device_id;
-          pTxFrame->ttl = FAN_TTL;
-          pTxFrame->command = FAN_NETWORK_JOIN_REQUEST;  // Request to connect to network
-          pTxFrame->parameter_count = sizeof(RfPayloadNetworkJoinOpen);
-          // Request to connect to the received network ID
-          pTxFrame->payload.networkJoinRequest.networkId = pResponse->payload.networkJoinOpen.networkId;
-
-          // Store for later
-          this->config_.fan_networkId = pResponse->payload.networkJoinOpen.networkId;
-          this->config_.fan_main_unit_type = pResponse->tx_type;
-          this->config_.fan_main_unit_id = pResponse->tx_id;
-
-          // Update address
-          rfConfig = this->rf_->getConfig();
-          rfConfig.rx_address = pResponse->payload.networkJoinOpen.networkId;
-          this->rf_->updateConfig(&rfConfig, NULL);
-          this->rf_->writeTxAddress(pResponse->payload.networkJoinOpen.networkId, NULL);
-
-          // Send response frame
-          this->startTransmit(this->_txFrame, FAN_TX_RETRIES, [this]() {
-            ESP_LOGW(TAG, "Query Timeout");
-            this->state_ = StateStartDiscovery;
-          });
-
-          this->state_ = StateDiscoveryWaitForJoinResponse;
-          break;
-
-        default:
-          ESP_LOGD(TAG, "Discovery: Received unknown frame type 0x%02X from ID 0x%02X", pResponse->command,
-                   pResponse->tx_id);
-          break;
-      }
-      break;
+  // Forward frames while the radio is not needed for our own exchanges
+  this->repeaterRun();
 
-    case StateDiscoveryWaitForJoinResponse:
-      ESP_LOGD(TAG, "DiscoverStateWaitForJoinResponse");
-      switch (pResponse->command) {
-        case FAN_FRAME_0B:
-          if ((pResponse->rx_type == this->config_.fan_my_device_type) &&
-              (pResponse->rx_id == this->config_.fan_my_device_id) &&
-              (pResponse->tx_type == this->config_.fan_main_unit_type) &&
-              (pResponse->tx_id == this->config_.fan_main_unit_id)) {
-            ESP_LOGD(TAG, "Discovery: Link successful to unit with ID 0x%02X on network 0x%08X", pResponse->tx_id,
-                     this->config_.fan_networkId);
-
-            this->rfComplete();
-
-            (void) memset(this->_txFrame, 0, FAN_FRAMESIZE);  // Clear frame data
-
-            pTxFrame->rx_type = FAN_TYPE_MAIN_UNIT;  // Set type to main unit
-            pTxFrame->rx_id = pResponse->tx_id;      // Set ID to the ID of the main unit
-            pTxFrame->tx_type = this->config_.fan_my_device_type;
-            pTxFrame->tx_id = this->config_.fan_my_device_id;
-            pTxFrame->ttl = FAN_TTL;
-            pTxFrame->command = FAN_FRAME_0B;  // 0x0B acknowledge link successful
-            pTxFrame->parameter_count = 0x00;  // No parameters
-
-            // Send response frame
-            this->startTransmit(this->_txFrame, FAN_TX_RETRIES, [this]() {
-              ESP_LOGW(TAG, "Query Timeout");
-              this->state_ = StateStartDiscovery;
-            });
-
-            this->state_ = StateDiscoveryJoinComplete;
-          } else {
-            ESP_LOGE(TAG, "Discovery: Received unknown link success from ID 0x%02X on network 0x%08X", pResponse->tx_id,
-                     this->config_.fan_networkId);
-          }
-          break;
+  // Power the radio down when nothing is left to send or wait for
+  this->powerRun();
 
-        default:
-          ESP_LOGE(TAG, "Discovery: Received unknown frame type 0x%02X from ID 0x%02X", pResponse->command,
-                   pResponse->tx_id);
-          break;
-      }
-      break;
+  // Nothing in flight; sleep until the next deadline, or until a transaction or received frame wakes us
+  idle = this->radioIdleTime();
+  if (idle > 0) {
+    this->radioSleep(idle);
+  }
 
-    case StateDiscoveryJoinComplete:
-      ESP_LOGD(TAG, "StateDiscoveryJoinComplete");
-      switch (pResponse->command) {
-        case FAN_TYPE_QUERY_NETWORK:
-          if ((pResponse->rx_type == this->config_.fan_main_unit_type) &&
-              (pResponse->rx_id == this->config_.fan_main_unit_id) &&
-              (pResponse->tx_type == this->config_.fan_main_unit_type) &&
-              (pResponse->tx_id == this->config_.fan_main_unit_id)) {
-            ESP_LOGD(TAG, "Discovery: received network join success 0x0D");
-
-            this->rfComplete();
-
-            ESP_LOGD(TAG, "Saving pairing config");
-            this->pref_.save(&this->config_);
-
-            this->state_ = StateIdle;
-          } else {
-            ESP_LOGW(TAG, "Unexpected frame join reponse from Type 0x%02X ID 0x%02X", pResponse->tx_type,
-                     pResponse->tx_id);
-          }
-          break;
+  nrf905::memoryMeter.heapEnd();
+  nrf905::memoryMeter.stackEnd();
+}
 
-        default:
-          ESP_LOGE(TAG, "Discovery: Received unknown frame type 0x%02X from ID 0x%02X on network 0x%08X",
-                   pResponse->command, pResponse->tx_id, this->config_.fan_networkId);
-          break;
-      }
-      break;
+void ZehnderRF::radioCommands(void) {
+  RadioCommand command;
 
-    case StateWaitQueryResponse:
-      if ((pResponse->rx_type == this->config_.fan_my_device_type) &&  // If type
-          (pResponse->rx_id == this->config_.fan_my_device_id)) {      // and id match, it is for us
-        switch (pResponse->command) {
-          case FAN_TYPE_FAN_SETTINGS:
-            ESP_LOGD(TAG, "Received fan settings; speed: 0x%02X voltage: %i timer: %i",
-                     pResponse->payload.fanSettings.speed, pResponse->payload.fanSettings.voltage,
-                     pResponse->payload.fanSettings.timer);
+  while (this->radioCommands_.pop(&command) == true) {
+    switch (command.type) {
+      case RadioCommandSetting:
+        this->queueSetting(command.value, command.timer, command.voltage, command.commandId);
+        break;
 
-            this->rfComplete();
+      case RadioCommandInventory:
+        if (this->state_ == StateIdle) {
+          this->inventoryStart();
+        }
+        break;
 
-            this->state = pResponse->payload.fanSettings.speed > 0;
-            this->speed = pResponse->payload.fanSettings.speed;
-            this->publish_state();
+      case RadioCommandQuery:
+        if (this->state_ == StateIdle) {
+          this->queryDevice();
+        }
+        break;
 
-            this->state_ = StateIdle;
-            break;
+      case RadioCommandSnapshot:
+        (void) memcpy(this->snapshot_.inventory, this->inventory_, sizeof(this->inventory_));
+        this->snapshot_.inventoryCount = this->inventoryCount_;
+        this->snapshot_.txPower = this->txPower_;
+        this->snapshotDue_ = true;
+        break;
 
-          default:
-            ESP_LOGD(TAG, "Received unexpected frame; type 0x%02X from ID 0x%02X", pResponse->command,
-                     pResponse->tx_id);
-            break;
-        }
-      } else {
-        ESP_LOGD(TAG, "Received frame from unknown device; type 0x%02X from ID 0x%02X type 0x%02X", pResponse->command,
-                 pResponse->tx_id, pResponse->tx_type);
-      }
-      break;
+      default:
+        break;
+    }
+  }
+}
 
-    case StateWaitSetSpeedResponse:
-      if ((pResponse->rx_type == this->config_.fan_my_device_type) &&  // If type
-          (pResponse->rx_id == this->config_.fan_my_device_id)) {      // and id match, it is for us
-        switch (pResponse->command) {
-          case FAN_TYPE_FAN_SETTINGS:
-            ESP_LOGD(TAG, "Received fan settings; speed: 0x%02X voltage: %i timer: %i",
-                     pResponse->payload.fanSettings.speed, pResponse->payload.fanSettings.voltage,
-                     pResponse->payload.fanSettings.timer);
-            this->rfComplete();
-
-            this->rfComplete();
-
-            (void) memset(this->_txFrame, 0, FAN_FRAMESIZE);  // Clear frame data
-
-            pTxFrame->rx_type = this->config_.fan_main_unit_type;  // Set type to main unit
-            pTxFrame->rx_id = this->config_.fan_main_unit_id;      // Set ID to the ID of the main unit
-            pTxFrame->tx_type = this->config_.fan_my_device_type;
-            pTxFrame->tx_id = this->config_.fan_my_device_id;
-            pTxFrame->ttl = FAN_TTL;
-            pTxFrame->command = FAN_FRAME_SETSPEED_REPLY;  // 0x0B acknowledge link successful
-            pTxFrame->parameter_count = 0x03;              // 3 parameters
-            pTxFrame->payload.parameters[0] = 0x54;
-            pTxFrame->payload.parameters[1] = 0x03;
-            pTxFrame->payload.parameters[2] = 0x20;
-
-            // Send response frame
-            this->startTransmit(this->_txFrame, -1, NULL);
-
-            this->state_ = StateWaitSetSpeedConfirm;
-            break;
-
-          case FAN_FRAME_SETSPEED_REPLY:
-          case FAN_FRAME_SETVOLTAGE_REPLY:
-            // this->rfComplete();
-
-            // this->state_ = StateIdle;
-            break;
-
-          default:
-            ESP_LOGD(TAG, "Received unexpected frame; type 0x%02X from ID 0x%02X", pResponse->command,
-                     pResponse->tx_id);
-            break;
-        }
-      } else {
-        ESP_LOGD(TAG, "Received frame from unknown device; type 0x%02X from ID 0x%02X type 0x%02X", pResponse->command,
-                 pResponse->tx_id, pResponse->tx_type);
-      }
-      break;
+void ZehnderRF::radioSnapshot(void) {
+  RadioEvent event;
 
-    default:
-      ESP_LOGD(TAG, "Received frame from unknown device in unknown state; type 0x%02X from ID 0x%02X type 0x%02X",
-               pResponse->command, pResponse->tx_id, pResponse->tx_type);
-      break;
+  // Retried on the next step when the event queue is full
+  event.type = RadioEventSnapshot;
+  if ((this->snapshotDue_ == true) && (this->radioEvents_.push(event) == true)) {
+    this->snapshotDue_ = false;
   }
 }
 
-static uint8_t minmax(const uint8_t value, const uint8_t min, const uint8_t max) {
-  if (value <= min) {
-    return min;
-  } else if (value >= max) {
-    return max;
-  } else {
-    return value;
+void ZehnderRF::dumpTables(const InventoryEntry *const pInventory, const uint8_t inventoryCount,
+                           TxPowerController *const pTxPower) {
+  uint8_t i;
+
+  ESP_LOGCONFIG(TAG, "  Network devices    %u", inventoryCount);
+  for (i = 0; i < inventoryCount; ++i) {
+    ESP_LOGCONFIG(TAG, "    Type 0x%02X ID 0x%02X seen %u s ago", pInventory[i].type, pInventory[i].id,
+                  (this->clock_->millis() - pInventory[i].lastSeen) / 1000);
+  }
+  if (this->txPowerAdaptive_ == true) {
+    pTxPower->dump_config(TAG, this->clock_->millis());
   }
 }
 
-uint8_t ZehnderRF::createDeviceID(void) {
-  uint8_t random = (uint8_t) random_uint32();
-  // Generate random device_id; don't use 0x00 and 0xFF
+void ZehnderRF::radioEvents(void) {
+  RadioEvent event;
+
+  while (this->radioEvents_.pop(&event) == true) {
+    switch (event.type) {
+      case RadioEventFanSettings:
+        this->publishFanSettings(event.speed, event.voltage, event.timer);
+        break;
+
+      case RadioEventInventory:
+        this->publishSensor(this->networkDevicesSensor_, PublishNetworkDevices, event.devices);
+        break;
+
+      case RadioEventTxPower:
+        this->publishSensor(this->txPowerSensor_, PublishTxPower, event.txPower);
+        break;
 
-  // TODO: there's a 1 in 255 chance that the generated ID matches the ID of the main unit. Decide how to deal
-  // withthis (some sort of ping discovery?)
+      case RadioEventCommand:
+        this->commandNotify(event.command);
+        break;
 
-  return minmax(random, 1, 0xFE);
+      case RadioEventSnapshot:
+        ESP_LOGCONFIG(TAG, "Zehnder Fan tables from the radio task:");
+        this->dumpTables(this->snapshot_.inventory, this->snapshot_.inventoryCount, &this->snapshot_.txPower);
+        this->snapshotPending_ = false;
+        break;
+
+      default:
+        break;
+    }
+  }
 }
 
-void ZehnderRF::queryDevice(void) {
-  RfFrame *const pFrame = (RfFrame *) this->_txFrame;  // frame helper
+uint32_t ZehnderRF::getRamUsage(void) {
+  // Static objects and buffers of both components, plus the deepest stack use seen
+  return sizeof(ZehnderRF) + sizeof(nrf905::nRF905) + NRF905_HEX_STR_SIZE + nrf905::memoryMeter.getStackPeak();
+}
 
-  ESP_LOGD(TAG, "Query device");
+void ZehnderRF::rfHandleReceived(const uint8_t *const pData, const uint8_t dataLength) {
+  const RfFrame *const pResponse = (RfFrame *) pData;
+  Transaction *pTr;
+  uint16_t line;
+  bool handled = false;
 
-  this->lastFanQuery_ = millis();  // Update time
+  MEMORY_STACK_SAMPLE();
 
-  // Clear frame data
-  (void) memset(this->_txFrame, 0, FAN_FRAMESIZE);
+  this->radioIdle_ = false;
 
-  // Build frame
-  pFrame->rx_type = this->config_.fan_main_unit_type;
-  pFrame->rx_id = this->config_.fan_main_unit_id;
-  pFrame->tx_type = this->config_.fan_my_device_type;
-  pFrame->tx_id = this->config_.fan_my_device_id;
-  pFrame->ttl = FAN_TTL;
-  pFrame->command = FAN_TYPE_QUERY_DEVICE;
-  pFrame->parameter_count = 0x00;  // No parameters
+  if (this->state_ == StateDiscovery) {
+    // Learn the device IDs in use, so pairing does not pick one of them
+    if ((pResponse->tx_id != 0x00) && (pResponse->tx_id != 0xFF)) {
+      this->markIdInUse(pResponse->tx_id);
+    }
+  } else if (this->state_ == StateIdle) {
+    if ((pResponse->ttl == FAN_TTL) && (pResponse->tx_type == this->config_.fan_my_device_type) &&
+        (pResponse->tx_id == this->config_.fan_my_device_id)) {
+      // Not forwarded, so another device sent it with our ID
+      ++this->pairingStats_.idConflicts;
+      ESP_LOGW(TAG, "Another device uses our ID 0x%02X; pair again to pick a new ID", pResponse->tx_id);
+    } else {
+      this->inventoryUpdate(pResponse->tx_type, pResponse->tx_id);
+      this->repeaterOffer(pData);
+    }
+  }
 
-  this->startTransmit(this->_txFrame, FAN_TX_RETRIES, [this]() {
-    ESP_LOGW(TAG, "Query Timeout");
-    this->state_ = StateIdle;
-  });
+  if (this->transactionCount_ > 0) {
+    // Offer the frame to the active transaction
+    pTr = &this->transactions_[this->transactionHead_];
+    line = pTr->line;
 
-  this->state_ = StateWaitQueryResponse;
+    pTr->pRx = pData;
+    pTr->rxUsed = false;
+    this->transactionRun();
+    pTr->pRx = NULL;
+
+    // Handled if the transaction moved on or used the frame
+    handled = (this->transactionCount_ == 0) || (pTr != &this->transactions_[this->transactionHead_]) ||
+              (pTr->line != line) || (pTr->rxUsed == true);
+  }
+
+  if (handled == false) {
+    // Read because it was on the air, not because of a frame we sent
+    ++this->busPassive_.transfers;
+    this->busPassive_.bytes += sizeof(nrf905::Buffer);
+
+    ESP_LOGD(TAG, "Received unexpected frame; type 0x%02X from ID 0x%02X type 0x%02X", pResponse->command,
+             pResponse->tx_id, pResponse->tx_type);
+  }
 }
 
-void ZehnderRF::setSpeed(const uint8_t paramSpeed, const uint8_t paramTimer) {
+TransactionStatus ZehnderRF::flowDiscovery(Transaction *const pTr) {
   RfFrame *const pFrame = (RfFrame *) this->_txFrame;  // frame helper
-  uint8_t speed = paramSpeed;
-  uint8_t timer = paramTimer;
+  const RfFrame *pReply;
 
-  if (speed > this->speed_count_) {
-    ESP_LOGW(TAG, "Requested speed too high (%u)", speed);
-    speed = this->speed_count_;
-  }
+  TR_BEGIN(pTr);
 
-  ESP_LOGD(TAG, "Set speed: 0x%02X; Timer %u minutes", speed, timer);
+  this->config_.fan_my_device_type = FAN_TYPE_REMOTE_CONTROL;
+
+  for (pTr->param.discovery.attempt = 1; pTr->param.discovery.attempt <= PAIRING_ATTEMPTS;
+       ++pTr->param.discovery.attempt) {
+    ++this->pairingStats_.attempts;
+
+    if (pTr->param.discovery.attempt > 1) {
+      pTr->param.discovery.waitTime = this->pairingBackoff(pTr->param.discovery.attempt);
+      pTr->param.discovery.waitStart = this->clock_->millis();
+      ESP_LOGD(TAG, "Pairing attempt %u/%u in %u ms", pTr->param.discovery.attempt, PAIRING_ATTEMPTS,
+               pTr->param.discovery.waitTime);
+      TR_WAIT_UNTIL(pTr, (this->clock_->millis() - pTr->param.discovery.waitStart) >= pTr->param.discovery.waitTime);
+    }
 
-  if (this->state_ == StateIdle) {
+    // Listen on the link network first; if another device is pairing right now, back off instead of colliding
+    this->setNetwork(NETWORK_LINK_ID);
+    pTr->param.discovery.heard = false;
+    this->rf_->setMode(nrf905::Receive);
+    pTr->param.discovery.waitTime = PAIRING_LISTEN_TIME + (random_uint32() % PAIRING_LISTEN_TIME);
+    pTr->param.discovery.waitStart = this->clock_->millis();
+    TR_WAIT_UNTIL(pTr, this->pairingListen(pTr));
+    if (pTr->param.discovery.heard == true) {
+      ESP_LOGW(TAG, "Link channel in use, backing off");
+      continue;
+    }
+
+    this->config_.fan_my_device_id = this->createDeviceID();
+    ESP_LOGD(TAG, "Start discovery with ID 0x%02X", this->config_.fan_my_device_id);
+
+    // Set payload, available for linking
     (void) memset(this->_txFrame, 0, FAN_FRAMESIZE);  // Clear frame data
+    pFrame->rx_type = 0x04;
+    pFrame->rx_id = 0x00;
+    pFrame->tx_type = this->config_.fan_my_device_type;
+    pFrame->tx_id = this->config_.fan_my_device_id;
+    pFrame->ttl = FAN_TTL;
+    pFrame->command = FAN_NETWORK_JOIN_ACK;
+    pFrame->parameter_count = sizeof(RfPayloadNetworkJoinAck);
+    pFrame->payload.networkJoinAck.networkId = NETWORK_LINK_ID;
+
+    TR_SEND(pTr, FAN_TX_RETRIES);
+    // Wait for linking request from main unit
+    TR_AWAIT_REPLY(pTr, TR_REPLY(pTr)->command == FAN_NETWORK_JOIN_OPEN);
+    if (pTr->rxTimeout == true) {
+      ESP_LOGW(TAG, "Start discovery timeout");
+      continue;
+    }
+
+    pReply = TR_REPLY(pTr);
+    ESP_LOGD(TAG, "Discovery: Found unit type 0x%02X (%s) with ID 0x%02X on network 0x%08X", pReply->tx_type,
+             pReply->tx_type == FAN_TYPE_MAIN_UNIT ? "Main" : "?", pReply->tx_id,
+             pReply->payload.networkJoinOpen.networkId);
+
+    // Store for later
+    this->config_.fan_networkId = pReply->payload.networkJoinOpen.networkId;
+    this->config_.fan_main_unit_type = pReply->tx_type;
+    this->config_.fan_main_unit_id = pReply->tx_id;
+    this->markIdInUse(this->config_.fan_main_unit_id);
+
+    // Update address
+    this->setNetwork(this->config_.fan_networkId);
+
+    // Remotes and bridges already paired talk on the fan network only; learn their IDs before announcing ours
+    this->rf_->setMode(nrf905::Receive);
+    pTr->param.discovery.waitTime = PAIRING_FAN_LISTEN_TIME;
+    pTr->param.discovery.waitStart = this->clock_->millis();
+    TR_WAIT_UNTIL(pTr, this->pairingListen(pTr));
+
+    // Do not join with an ID that turned out to be taken
+    if (this->isIdInUse(this->config_.fan_my_device_id) == true) {
+      this->config_.fan_my_device_id = this->createDeviceID();
+      ESP_LOGD(TAG, "Device ID in use, join with ID 0x%02X", this->config_.fan_my_device_id);
+    }
 
-    // Build frame
-    pFrame->rx_type = this->config_.fan_main_unit_type;
-    pFrame->rx_id = this->config_.fan_main_unit_id;
+    // Found a main unit, so send a join request
+    (void) memset(this->_txFrame, 0, FAN_FRAMESIZE);  // Clear frame data
+    pFrame->rx_type = FAN_TYPE_MAIN_UNIT;             // Set type to main unit
+    pFrame->rx_id = this->config_.fan_main_unit_id;   // Set ID to the ID of the main unit
     pFrame->tx_type = this->config_.fan_my_device_type;
     pFrame->tx_id = this->config_.fan_my_device_id;
     pFrame->ttl = FAN_TTL;
+    pFrame->command = FAN_NETWORK_JOIN_REQUEST;  // Request to connect to network
+    pFrame->parameter_count = sizeof(RfPayloadNetworkJoinOpen);
+    // Request to connect to the received network ID
+    pFrame->payload.networkJoinRequest.networkId = this->config_.fan_networkId;
+
+    TR_SEND(pTr, FAN_TX_RETRIES);
+    TR_AWAIT_REPLY(pTr, (TR_REPLY(pTr)->command == FAN_FRAME_0B) &&
+                            (TR_REPLY(pTr)->rx_type == this->config_.fan_my_device_type) &&
+                            (TR_REPLY(pTr)->rx_id == this->config_.fan_my_device_id) &&
+                            (TR_REPLY(pTr)->tx_type == this->config_.fan_main_unit_type) &&
+                            (TR_REPLY(pTr)->tx_id == this->config_.fan_main_unit_id));
+    if (pTr->rxTimeout == true) {
+      ESP_LOGW(TAG, "Join request timeout");
+      continue;
+    }
 
-    if (timer == 0) {
-      pFrame->command = FAN_FRAME_SETSPEED;
-      pFrame->parameter_count = sizeof(RfPayloadFanSetSpeed);
-      pFrame->payload.setSpeed.speed = speed;
-    } else {
-      pFrame->command = FAN_FRAME_SETTIMER;
-      pFrame->parameter_count = sizeof(RfPayloadFanSetTimer);
-      pFrame->payload.setTimer.speed = speed;
-      pFrame->payload.setTimer.timer = timer;
+    ESP_LOGD(TAG, "Discovery: Link successful to unit with ID 0x%02X on network 0x%08X",
+             this->config_.fan_main_unit_id, this->config_.fan_networkId);
+
+    (void) memset(this->_txFrame, 0, FAN_FRAMESIZE);  // Clear frame data
+    pFrame->rx_type = FAN_TYPE_MAIN_UNIT;             // Set type to main unit
+    pFrame->rx_id = this->config_.fan_main_unit_id;   // Set ID to the ID of the main unit
+    pFrame->tx_type = this->config_.fan_my_device_type;
+    pFrame->tx_id = this->config_.fan_my_device_id;
+    pFrame->ttl = FAN_TTL;
+    pFrame->command = FAN_FRAME_0B;  // 0x0B acknowledge link successful
+    pFrame->parameter_count = 0x00;  // No parameters
+
+    TR_SEND(pTr, FAN_TX_RETRIES);
+    TR_AWAIT_REPLY(pTr, (TR_REPLY(pTr)->command == FAN_TYPE_QUERY_NETWORK) &&
+                            (TR_REPLY(pTr)->rx_type == this->config_.fan_main_unit_type) &&
+                            (TR_REPLY(pTr)->rx_id == this->config_.fan_main_unit_id) &&
+                            (TR_REPLY(pTr)->tx_type == this->config_.fan_main_unit_type) &&
+                            (TR_REPLY(pTr)->tx_id == this->config_.fan_main_unit_id));
+    if (pTr->rxTimeout == true) {
+      ESP_LOGW(TAG, "Join complete timeout");
+      continue;
     }
 
-    this->startTransmit(this->_txFrame, FAN_TX_RETRIES, [this]() {
-      ESP_LOGW(TAG, "Set speed timeout");
-      this->state_ = StateIdle;
-    });
+    ESP_LOGD(TAG, "Discovery: received network join success 0x0D");
 
-    newSetting = false;
-    this->state_ = StateWaitSetSpeedResponse;
-  } else {
-    ESP_LOGD(TAG, "Invalid state, I'm trying later again");
-    newSpeed = speed;
-    newTimer = timer;
-    newSetting = true;
+    this->pairingStats_.lastDuration = this->clock_->millis() - pTr->startTime;
+    ESP_LOGI(TAG, "Paired with ID 0x%02X in %u ms (attempt %u)", this->config_.fan_my_device_id,
+             this->pairingStats_.lastDuration, pTr->param.discovery.attempt);
+
+    ESP_LOGD(TAG, "Saving pairing config");
+    this->pref_.save(&this->config_);
+
+    this->state_ = StateIdle;
+    this->inventoryStart();
+    TR_EXIT(pTr);
+  }
+
+  // Out of attempts; stay off the link channel for a while
+  this->pairingStats_.lastDuration = this->clock_->millis() - pTr->startTime;
+  ++this->pairingStats_.timeouts;
+  ESP_LOGE(TAG, "Pairing timed out after %u attempts in %u s, retrying in %u minutes", PAIRING_ATTEMPTS,
+           this->pairingStats_.lastDuration / 1000, PAIRING_RETRY_INTERVAL / 60000);
+
+  this->pairingTimeoutTime_ = this->clock_->millis();
+  this->state_ = StatePairingTimeout;
+
+  TR_END(pTr);
+}
+
+bool ZehnderRF::pairingListen(Transaction *const pTr) {
+  if (pTr->pRx != NULL) {
+    pTr->rxUsed = true;
+    pTr->param.discovery.heard = true;
+  }
+
+  return (this->clock_->millis() - pTr->param.discovery.waitStart) >= pTr->param.discovery.waitTime;
+}
+
+uint16_t ZehnderRF::pairingBackoff(const uint8_t attempt) {
+  uint32_t backoff = PAIRING_BACKOFF << (attempt - 2);
+
+  if (backoff > PAIRING_BACKOFF_MAX) {
+    backoff = PAIRING_BACKOFF_MAX;
   }
+
+  // Up to 50% jitter, so devices that failed together do not retry together
+  return backoff + (random_uint32() % (backoff / 2 + 1));
 }
 
-void ZehnderRF::discoveryStart(const uint8_t deviceId) {
+TransactionStatus ZehnderRF::flowQuery(Transaction *const pTr) {
   RfFrame *const pFrame = (RfFrame *) this->_txFrame;  // frame helper
-  nrf905::Config rfConfig;
+  const RfFrame *pReply;
 
-  ESP_LOGD(TAG, "Start discovery with ID %u", deviceId);
+  TR_BEGIN(pTr);
 
-  this->config_.fan_my_device_type = FAN_TYPE_REMOTE_CONTROL;
-  this->config_.fan_my_device_id = deviceId;
+  ESP_LOGD(TAG, "Query device");
 
   // Build frame
   (void) memset(this->_txFrame, 0, FAN_FRAMESIZE);  // Clear frame data
-
-  // Set payload, available for linking
-  pFrame->rx_type = 0x04;
-  pFrame->rx_id = 0x00;
+  pFrame->rx_type = this->config_.fan_main_unit_type;
+  pFrame->rx_id = this->config_.fan_main_unit_id;
   pFrame->tx_type = this->config_.fan_my_device_type;
   pFrame->tx_id = this->config_.fan_my_device_id;
   pFrame->ttl = FAN_TTL;
-  pFrame->command = FAN_NETWORK_JOIN_ACK;
-  pFrame->parameter_count = sizeof(RfPayloadNetworkJoinAck);
-  pFrame->payload.networkJoinAck.networkId = NETWORK_LINK_ID;
+  pFrame->command = FAN_TYPE_QUERY_DEVICE;
+  pFrame->parameter_count = 0x00;  // No parameters
 
-  // Set RX and TX address
-  rfConfig = this->rf_->getConfig();
-  rfConfig.rx_address = NETWORK_LINK_ID;
-  this->rf_->updateConfig(&rfConfig, NULL);
-  this->rf_->writeTxAddress(NETWORK_LINK_ID, NULL);
+  TR_SEND(pTr, FAN_TX_RETRIES);
+  TR_AWAIT_REPLY(pTr, (TR_REPLY(pTr)->command == FAN_TYPE_FAN_SETTINGS) &&
+                          (TR_REPLY(pTr)->rx_type == this->config_.fan_my_device_type) &&
+                          (TR_REPLY(pTr)->rx_id == this->config_.fan_my_device_id));
+  if (pTr->rxTimeout == true) {
+    ESP_LOGW(TAG, "Query Timeout");
+    TR_EXIT(pTr);
+  }
 
-  this->startTransmit(this->_txFrame, FAN_TX_RETRIES, [this]() {
-    ESP_LOGW(TAG, "Start discovery timeout");
-    this->state_ = StateStartDiscovery;
-  });
+  pReply = TR_REPLY(pTr);
+  this->updateFanSettings(pReply->payload.fanSettings.speed, pReply->payload.fanSettings.voltage,
+                          pReply->payload.fanSettings.timer);
 
-  // Update state
-  this->state_ = StateDiscoveryWaitForLinkRequest;
+  TR_END(pTr);
 }
 
-Result ZehnderRF::startTransmit(const uint8_t *const pData, const int8_t rxRetries,
-                                const std::function<void(void)> callback) {
-  Result result = ResultOk;
-  unsigned long startTime;
-  bool busy = true;
+TransactionStatus ZehnderRF::flowSetSpeed(Transaction *const pTr) {
+  RfFrame *const pFrame = (RfFrame *) this->_txFrame;  // frame helper
+  const RfFrame *pReply;
 
-  if (this->rfState_ != RfStateIdle) {
-    ESP_LOGW(TAG, "TX still ongoing");
-    result = ResultBusy;
+  TR_BEGIN(pTr);
+
+  // Build frame
+  (void) memset(this->_txFrame, 0, FAN_FRAMESIZE);  // Clear frame data
+  pFrame->rx_type = this->config_.fan_main_unit_type;
+  pFrame->rx_id = this->config_.fan_main_unit_id;
+  pFrame->tx_type = this->config_.fan_my_device_type;
+  pFrame->tx_id = this->config_.fan_my_device_id;
+  pFrame->ttl = FAN_TTL;
+
+  if (pTr->param.setSpeed.voltage == true) {
+    ESP_LOGD(TAG, "Set voltage: %u.%u V", pTr->param.setSpeed.speed / 10, pTr->param.setSpeed.speed % 10);
+
+    pFrame->command = FAN_FRAME_SETVOLTAGE;
+    pFrame->parameter_count = sizeof(RfPayloadFanSetVoltage);
+    pFrame->payload.setVoltage.voltage = pTr->param.setSpeed.speed;
+  } else if (pTr->param.setSpeed.timer == 0) {
+    ESP_LOGD(TAG, "Set speed: 0x%02X", pTr->param.setSpeed.speed);
+
+    pFrame->command = FAN_FRAME_SETSPEED;
+    pFrame->parameter_count = sizeof(RfPayloadFanSetSpeed);
+    pFrame->payload.setSpeed.speed = pTr->param.setSpeed.speed;
   } else {
-    this->onReceiveTimeout_ = callback;
-    this->retries_ = rxRetries;
+    ESP_LOGD(TAG, "Set speed: 0x%02X; Timer %u minutes", pTr->param.setSpeed.speed, pTr->param.setSpeed.timer);
 
-    // Write data to RF
-    // if (pData != NULL) {  // If frame given, load it in the nRF. Else use previous TX payload
-    // ESP_LOGD(TAG, "Write payload");
-    this->rf_->writeTxPayload(pData, FAN_FRAMESIZE);  // Use framesize
-    // }
+    pFrame->command = FAN_FRAME_SETTIMER;
+    pFrame->parameter_count = sizeof(RfPayloadFanSetTimer);
+    pFrame->payload.setTimer.speed = pTr->param.setSpeed.speed;
+    pFrame->payload.setTimer.timer = pTr->param.setSpeed.timer;
+  }
 
-    this->rfState_ = RfStateWaitAirwayFree;
-    this->airwayFreeWaitTime_ = millis();
+  TR_SEND(pTr, FAN_TX_RETRIES);
+  TR_AWAIT_REPLY(pTr, (TR_REPLY(pTr)->command == FAN_TYPE_FAN_SETTINGS) &&
+                          (TR_REPLY(pTr)->rx_type == this->config_.fan_my_device_type) &&
+                          (TR_REPLY(pTr)->rx_id == this->config_.fan_my_device_id));
+  if (pTr->rxTimeout == true) {
+    ESP_LOGW(TAG, "Set speed timeout");
+    this->commandDone(pTr->param.setSpeed.commandId, CommandTimeout, FAN_TX_RETRIES, pTr->startTime);
+    TR_EXIT(pTr);
   }
 
-  return result;
-}
+  pReply = TR_REPLY(pTr);
+  if ((pTr->param.setSpeed.voltage == true) && (pReply->payload.fanSettings.voltage != pTr->param.setSpeed.speed)) {
+    ESP_LOGW(TAG, "Fan reports voltage %u instead of %u", pReply->payload.fanSettings.voltage,
+             pTr->param.setSpeed.speed);
+  }
+  this->updateFanSettings(pReply->payload.fanSettings.speed, pReply->payload.fanSettings.voltage,
+                          pReply->payload.fanSettings.timer);
+  // After the settings; in radio task mode the success applies the confirmed state they carry
+  this->commandDone(pTr->param.setSpeed.commandId, CommandSuccess, this->txRetriesUsed_, pTr->startTime);
 
-void ZehnderRF::rfComplete(void) {
-  this->retries_ = -1;  // Disable this->retries_
-  this->rfState_ = RfStateIdle;
+  (void) memset(this->_txFrame, 0, FAN_FRAMESIZE);  // Clear frame data
+  pFrame->rx_type = this->config_.fan_main_unit_type;  // Set type to main unit
+  pFrame->rx_id = this->config_.fan_main_unit_id;      // Set ID to the ID of the main unit
+  pFrame->tx_type = this->config_.fan_my_device_type;
+  pFrame->tx_id = this->config_.fan_my_device_id;
+  pFrame->ttl = FAN_TTL;
+  // Acknowledge the new settings
+  pFrame->command = (pTr->param.setSpeed.voltage == true) ? FAN_FRAME_SETVOLTAGE_REPLY : FAN_FRAME_SETSPEED_REPLY;
+  pFrame->parameter_count = 0x03;  // 3 parameters
+  pFrame->payload.parameters[0] = 0x54;
+  pFrame->payload.parameters[1] = 0x03;
+  pFrame->payload.parameters[2] = 0x20;
+
+  // Send response frame; the next transaction can stage its frame while this one is on air
+  TR_SEND(pTr, -1);
+
+  TR_END(pTr);
 }
 
-void ZehnderRF::rfHandler(void) {
-  switch (this->rfState_) {
-    case RfStateIdle:
-      break;
+TransactionStatus ZehnderRF::flowInventory(Transaction *const pTr) {
+  RfFrame *const pFrame = (RfFrame *) this->_txFrame;  // frame helper
+  uint8_t i;
 
-    case RfStateWaitAirwayFree:
-      if ((millis() - this->airwayFreeWaitTime_) > 5000) {
-        ESP_LOGW(TAG, "Airway too busy, giving up");
-        this->rfState_ = RfStateIdle;
+  TR_BEGIN(pTr);
 
-        if (this->onReceiveTimeout_ != NULL) {
-          this->onReceiveTimeout_();
-        }
-      } else if (this->rf_->airwayBusy() == false) {
-        ESP_LOGD(TAG, "Start TX");
+  ESP_LOGD(TAG, "Inventory sweep");
+
+  // Broadcast a network query; every device on the network answers
+  (void) memset(this->_txFrame, 0, FAN_FRAMESIZE);  // Clear frame data
+  pFrame->rx_type = FAN_TYPE_BROADCAST;
+  pFrame->rx_id = 0x00;
+  pFrame->tx_type = this->config_.fan_my_device_type;
+  pFrame->tx_id = this->config_.fan_my_device_id;
+  pFrame->ttl = FAN_TTL;
+  pFrame->command = FAN_TYPE_QUERY_NETWORK;
+  pFrame->parameter_count = 0x00;  // No parameters
+
+  TR_SEND(pTr, -1);
+  TR_WAIT_UNTIL(pTr, this->rfState_ == RfStateIdle);
+
+  // Replies update the inventory in rfHandleReceived; only count them here
+  pTr->param.inventory.replies = 0;
+  pTr->param.inventory.windowStart = this->clock_->millis();
+  TR_WAIT_UNTIL(pTr, this->inventoryCollect(pTr));
+
+  ESP_LOGI(TAG, "Inventory: %u replies, %u devices known", pTr->param.inventory.replies, this->inventoryCount_);
+  for (i = 0; i < this->inventoryCount_; ++i) {
+    ESP_LOGD(TAG, "  Type 0x%02X ID 0x%02X seen %u s ago", this->inventory_[i].type, this->inventory_[i].id,
+             (this->clock_->millis() - this->inventory_[i].lastSeen) / 1000);
+  }
+
+  this->publishInventory(this->inventoryCount_);
+
+  TR_END(pTr);
+}
+
+bool ZehnderRF::inventoryCollect(Transaction *const pTr) {
+  if (pTr->pRx != NULL) {
+    pTr->rxUsed = true;
+    ++pTr->param.inventory.replies;
+  }
+
+  return (this->clock_->millis() - pTr->param.inventory.windowStart) >= INVENTORY_WINDOW;
+}
+
+void ZehnderRF::inventoryUpdate(const uint8_t type, const uint8_t id) {
+  InventoryEntry *pEntry = NULL;
+  uint8_t i;
+
+  if ((id == 0x00) || (id == 0xFF) ||
+      ((type == this->config_.fan_my_device_type) && (id == this->config_.fan_my_device_id))) {
+    return;  // Broadcast, or ourselves
+  }
+
+  for (i = 0; (i < this->inventoryCount_) && (pEntry == NULL); ++i) {
+    if ((this->inventory_[i].type == type) && (this->inventory_[i].id == id)) {
+      pEntry = &this->inventory_[i];
+    }
+  }
+
+  if (pEntry == NULL) {
+    if (this->inventoryCount_ < INVENTORY_SIZE) {
+      pEntry = &this->inventory_[this->inventoryCount_++];
+    } else {
+      // Full; replace the device not heard from for the longest time
+      pEntry = &this->inventory_[0];
+      for (i = 1; i < INVENTORY_SIZE; ++i) {
+        if ((this->clock_->millis() - this->inventory_[i].lastSeen) > (this->clock_->millis() - pEntry->lastSeen)) {
+          pEntry = &this->inventory_[i];
+        }
+      }
+    }
+    ESP_LOGD(TAG, "New device type 0x%02X ID 0x%02X", type, id);
+    pEntry->type = type;
+    pEntry->id = id;
+  }
+
+  pEntry->lastSeen = this->clock_->millis();
+}
+
+void ZehnderRF::add_schedule_entry(const uint8_t days, const uint8_t hour, const uint8_t minute, const uint8_t speed,
+                                   const uint8_t timer) {
+  const ScheduleEntry entry = {days, hour, minute, speed, timer};
+
+  if (this->schedule_.add(entry) == false) {
+    ESP_LOGW(TAG, "Schedule full, dropping entry %02u:%02u", hour, minute);
+  }
+}
+
+bool ZehnderRF::setScheduleEntry(const uint8_t index, const uint8_t days, const uint8_t hour, const uint8_t minute,
+                                 const uint8_t speed, const uint8_t timer) {
+  const ScheduleEntry entry = {days, hour, minute, speed, timer};
+
+  if (this->schedule_.set(index, entry) == false) {
+    return false;
+  }
+  this->scheduleSave();
+  return true;
+}
+
+bool ZehnderRF::clearScheduleEntry(const uint8_t index) {
+  const ScheduleEntry entry = {0, 0, 0, 0, 0};
+
+  if (this->schedule_.set(index, entry) == false) {
+    return false;
+  }
+  this->scheduleSave();
+  return true;
+}
+
+void ZehnderRF::scheduleLoad(void) {
+  ScheduleTable table;
+
+  // A saved table wins as long as it was derived from the same configured table
+  this->scheduleVersion_ = this->schedule_.hash();
+  this->schedulePref_ = global_preferences->make_preference<ScheduleTable>(fnv1_hash("zehnderschedule"), true);
+  if ((this->schedulePref_.load(&table) == true) && (table.version == this->scheduleVersion_)) {
+    this->schedule_.setTable(&table);
+    ESP_LOGD(TAG, "Schedule load ok");
+  } else {
+    table = *this->schedule_.getTable();
+    table.version = this->scheduleVersion_;
+    this->schedule_.setTable(&table);
+  }
+}
+
+void ZehnderRF::scheduleSave(void) {
+  ScheduleTable table = *this->schedule_.getTable();
+
+  table.version = this->scheduleVersion_;
+  this->schedule_.setTable(&table);
+  (void) this->schedulePref_.save(&table);
+  this->scheduleStale_ = true;
+}
+
+void ZehnderRF::scheduleRun(void) {
+#ifdef USE_TIME
+  const ScheduleEntry *pEntry;
+  ESPTime now;
+  uint16_t minutes;
+
+  now = this->time_->now();
+  if (now.is_valid() == false) {
+    return;
+  }
+
+  if ((this->scheduleNext_ >= 0) && (now.timestamp >= this->scheduleDue_)) {
+    pEntry = this->schedule_.get(this->scheduleNext_);
+    if ((now.timestamp - this->scheduleDue_) > SCHEDULE_LATE_LIMIT) {
+      ESP_LOGW(TAG, "Schedule entry %u skipped, clock moved", this->scheduleNext_);
+    } else if (this->speedMode_ == SpeedModeVoltage) {
+      ESP_LOGI(TAG, "Schedule entry %u: voltage %u", this->scheduleNext_, pEntry->speed);
+      (void) this->setVoltage(pEntry->speed);
+    } else {
+      ESP_LOGI(TAG, "Schedule entry %u: speed %u, timer %u", this->scheduleNext_, pEntry->speed, pEntry->timer);
+      (void) this->setSpeed(pEntry->speed, pEntry->timer);
+    }
+    this->scheduleStale_ = true;
+  }
+
+  // Only the next entry is tracked; look it up again after it ran, hourly, or when the clock went back
+  if ((this->scheduleStale_ == true) || (now.timestamp < this->scheduleLookup_) ||
+      ((now.timestamp - this->scheduleLookup_) >= SCHEDULE_RESYNC)) {
+    this->scheduleNext_ =
+        this->schedule_.next(now.day_of_week - 1, (now.hour * 60) + now.minute, &minutes);  // ESPTime: Sunday = 1
+    this->scheduleDue_ = now.timestamp - now.second + (minutes * 60);
+    this->scheduleLookup_ = now.timestamp;
+    this->scheduleStale_ = false;
+    if (this->scheduleNext_ >= 0) {
+      ESP_LOGD(TAG, "Next schedule entry %u in %u minutes", this->scheduleNext_, minutes);
+    }
+  }
+#endif
+}
+
+void ZehnderRF::repeaterOffer(const uint8_t *const pData) {
+  const RfFrame *const pFrame = (const RfFrame *) pData;
+
+  if (this->repeaterEnabled_ == false) {
+    return;
+  }
+
+  // Frames for us, our own frames sent back by another repeater and broadcasts (which reach us as well) stay here
+  if ((pFrame->rx_type == FAN_TYPE_BROADCAST) ||
+      ((pFrame->rx_type == this->config_.fan_my_device_type) && (pFrame->rx_id == this->config_.fan_my_device_id)) ||
+      ((pFrame->tx_type == this->config_.fan_my_device_type) && (pFrame->tx_id == this->config_.fan_my_device_id))) {
+    return;
+  }
+
+  if (this->repeater_.offer(pData, this->clock_->millis()) == true) {
+    ESP_LOGV(TAG, "Forward frame 0x%02X from 0x%02X/0x%02X to 0x%02X/0x%02X, TTL %u", pFrame->command,
+             pFrame->tx_type, pFrame->tx_id, pFrame->rx_type, pFrame->rx_id, pFrame->ttl);
+  }
+}
+
+void ZehnderRF::repeaterRun(void) {
+  const uint8_t *pData;
+
+  if ((this->repeaterEnabled_ == false) || (this->state_ != StateIdle) || (this->rfState_ != RfStateIdle)) {
+    return;
+  }
+
+  pData = this->repeater_.due(this->clock_->millis());
+  if ((pData != NULL) && (this->startTransmit(pData) == ResultOk)) {
+    this->repeater_.sent();
+  }
+}
+
+void ZehnderRF::publishInventory(const uint8_t count) {
+  RadioEvent event;
+
+  if (this->radioTask_ == false) {
+    this->publishSensor(this->networkDevicesSensor_, PublishNetworkDevices, count);
+    return;
+  }
+
+  event.type = RadioEventInventory;
+  event.devices = count;
+  if (this->radioEvents_.push(event) == false) {
+    ESP_LOGW(TAG, "Radio event queue full, dropping inventory");
+  }
+}
+
+void ZehnderRF::demandUpdate(const float value) {
+  uint8_t output;
+
+  if (this->state_ != StateIdle) {
+    return;  // Not paired yet
+  }
+
+  // Only acts when the demand level changes, so a manual setting holds until then
+  if (this->demand_.update(value, this->clock_->millis(), &output) == true) {
+    ESP_LOGI(TAG, "Demand %.1f, set output %u", value, output);
+
+    if (this->speedMode_ == SpeedModeVoltage) {
+      this->setVoltage(output);
+    } else {
+      this->setSpeed(output, 0);
+    }
+  }
+}
+
+static uint8_t minmax(const uint8_t value, const uint8_t min, const uint8_t max) {
+  if (value <= min) {
+    return min;
+  } else if (value >= max) {
+    return max;
+  } else {
+    return value;
+  }
+}
+
+uint8_t ZehnderRF::createDeviceID(void) {
+  uint8_t id = minmax((uint8_t) random_uint32(), 1, 0xFE);  // Don't use 0x00 and 0xFF
+  uint8_t i;
+
+  // Skip IDs heard on the network during pairing, the main unit included
+  for (i = 0; (i < 0xFE) && (this->isIdInUse(id) == true); ++i) {
+    id = (id < 0xFE) ? id + 1 : 1;
+  }
+
+  return id;
+}
+
+bool ZehnderRF::isPaired(void) {
+  return (this->config_.fan_networkId != 0x00000000) && (this->config_.fan_my_device_type != 0) &&
+         (this->config_.fan_my_device_id != 0) && (this->config_.fan_main_unit_type != 0) &&
+         (this->config_.fan_main_unit_id != 0);
+}
+
+void ZehnderRF::setNetwork(const uint32_t networkId) {
+  nrf905::Config rfConfig;
+
+  rfConfig = this->rf_->getConfig();
+  rfConfig.rx_address = networkId;
+  this->rf_->updateConfig(&rfConfig);
+  this->rf_->writeTxAddress(networkId);
+}
+
+uint32_t ZehnderRF::pollInterval(void) {
+  const nrf905::OccupancyProfiler *const pOccupancy = this->rf_->getOccupancy();
+
+  // Poll half as often in hours the channel is known to be busy
+  if ((pOccupancy != NULL) && (pOccupancy->isBusyHour(this->rf_->getHour()) == true)) {
+    return 2 * this->interval_;
+  }
+
+  return this->interval_;
+}
+
+void ZehnderRF::queryDevice(void) {
+  this->lastFanQuery_ = this->clock_->millis();  // Update time
+
+  (void) this->transactionStart(&ZehnderRF::flowQuery);
+}
+
+void ZehnderRF::inventoryStart(void) { (void) this->transactionStart(&ZehnderRF::flowInventory); }
+
+void ZehnderRF::inventorySweep(void) {
+  RadioCommand command;
+
+  if (this->radioTask_ == false) {
+    this->inventoryStart();
+    return;
+  }
+
+  command.type = RadioCommandInventory;
+  if (this->radioCommands_.push(command) == false) {
+    ESP_LOGW(TAG, "Radio command queue full, dropping inventory sweep");
+  }
+}
+
+uint16_t ZehnderRF::setSpeed(const uint8_t paramSpeed, const uint8_t paramTimer) {
+  uint8_t speed = paramSpeed;
+
+  if (speed > FAN_SPEED_MAX) {
+    ESP_LOGW(TAG, "Requested speed too high (%u)", speed);
+    speed = FAN_SPEED_MAX;
+  }
+
+  return this->submitSetting(speed, paramTimer, false);
+}
+
+uint16_t ZehnderRF::setVoltage(const uint8_t paramVoltage) {
+  uint8_t voltage = paramVoltage;
+
+  if (voltage > FAN_VOLTAGE_MAX) {
+    ESP_LOGW(TAG, "Requested voltage too high (%u)", voltage);
+    voltage = FAN_VOLTAGE_MAX;
+  }
+
+  return this->submitSetting(voltage, 0, true);
+}
+
+uint16_t ZehnderRF::submitSetting(const uint8_t value, const uint8_t timer, const bool voltage) {
+  RadioCommand command;
+  uint16_t commandId;
+
+  // Never hand out 0, so callers can use it for 'no command'
+  if (++this->nextCommandId_ == 0) {
+    ++this->nextCommandId_;
+  }
+  commandId = this->nextCommandId_;
+  this->commandTrack(commandId);
+
+  if (this->radioTask_ == false) {
+    this->queueSetting(value, timer, voltage, commandId);
+    return commandId;
+  }
+
+  // Transactions belong to the radio task; hand the setting over
+  command.type = RadioCommandSetting;
+  command.value = value;
+  command.timer = timer;
+  command.voltage = voltage;
+  command.commandId = commandId;
+  if (this->radioCommands_.push(command) == false) {
+    const CommandOutcome outcome = {commandId, CommandRejected, 0, 0};
+
+    ESP_LOGW(TAG, "Radio command queue full, dropping set speed 0x%02X", value);
+    // The event queue belongs to the radio task; report after the caller has the ID
+    this->defer([this, outcome]() { this->commandNotify(outcome); });
+  }
+
+  return commandId;
+}
+
+void ZehnderRF::queueSetting(const uint8_t value, const uint8_t timer, const bool voltage, const uint16_t commandId) {
+  Transaction *pTr;
+  uint8_t i;
+
+  if ((this->state_ != StateIdle) && ((this->state_ != StateStartup) || (this->isPaired() == false))) {
+    ESP_LOGW(TAG, "Not paired, ignoring set speed 0x%02X", value);
+    this->commandDone(commandId, CommandRejected, 0, this->clock_->millis());
+    return;
+  }
+
+  this->lastFanQuery_ = this->clock_->millis();  // Setting is answered with the fan settings; delay the next poll
+
+  // A set speed that did not start yet is replaced by the new setting
+  for (i = 1; i < this->transactionCount_; ++i) {
+    pTr = &this->transactions_[(this->transactionHead_ + i) % TRANSACTION_SLOTS];
+    if (pTr->flow == &ZehnderRF::flowSetSpeed) {
+      ESP_LOGD(TAG, "Update queued set speed: 0x%02X; Timer %u minutes", value, timer);
+      this->commandDone(pTr->param.setSpeed.commandId, CommandReplaced, 0, pTr->startTime);
+      pTr->param.setSpeed.speed = value;
+      pTr->param.setSpeed.timer = timer;
+      pTr->param.setSpeed.voltage = voltage;
+      pTr->param.setSpeed.commandId = commandId;
+      pTr->startTime = this->clock_->millis();
+      return;
+    }
+  }
+
+  pTr = this->transactionStart(&ZehnderRF::flowSetSpeed);
+  if (pTr != NULL) {
+    pTr->param.setSpeed.speed = value;
+    pTr->param.setSpeed.timer = timer;
+    pTr->param.setSpeed.voltage = voltage;
+    pTr->param.setSpeed.commandId = commandId;
+  } else {
+    this->commandDone(commandId, CommandRejected, 0, this->clock_->millis());
+  }
+}
+
+void ZehnderRF::commandDone(const uint16_t commandId, const CommandResult result, const uint8_t retries,
+                            const uint32_t startTime) {
+  RadioEvent event;
+
+  // Outcomes always go through the event queue, so they are reported from the main loop after the caller got the ID
+  event.type = RadioEventCommand;
+  event.command.id = commandId;
+  event.command.result = result;
+  event.command.retries = retries;
+  event.command.latency = this->clock_->millis() - startTime;
+  if (this->radioEvents_.push(event) == false) {
+    // pendingCheck() still reports it, as a timeout
+    ++this->outcomeDrops_;
+    ESP_LOGW(TAG, "Radio event queue full, dropping outcome of command %u", commandId);
+  }
+}
+
+void ZehnderRF::commandNotify(const CommandOutcome &outcome) {
+  CommandStats *const pStats = &this->commandStats_;
+
+  if ((outcome.id != 0) && (this->commandUntrack(outcome.id) == false)) {
+    // Already reported as timed out by pendingCheck(); report every command once
+    ESP_LOGD(TAG, "Command %u %s after its timeout", outcome.id, commandResultToStr(outcome.result));
+    return;
+  }
+
+  switch (outcome.result) {
+    case CommandSuccess:
+      ++pStats->success;
+      if (outcome.latency > pStats->maxLatency) {
+        pStats->maxLatency = outcome.latency;
+      }
+      break;
+
+    case CommandTimeout:
+      ++pStats->timeouts;
+      break;
+
+    case CommandReplaced:
+      ++pStats->replaced;
+      break;
+
+    default:
+      ++pStats->rejected;
+      break;
+  }
+
+  ESP_LOGD(TAG, "Command %u %s; %u retries, %u ms", outcome.id, commandResultToStr(outcome.result), outcome.retries,
+           outcome.latency);
+
+  if ((outcome.id != 0) && (outcome.id == this->pendingCommand_)) {
+    this->setPending(0);
+    if (outcome.result == CommandSuccess) {
+      // The reply to the command is the latest confirmed state
+      this->applyConfirmed();
+    } else if (outcome.result != CommandReplaced) {
+      // A replacing command reports on its own; anything else failed, so go back to what the fan last said
+      ESP_LOGW(TAG, "Requested state not confirmed, rolling back");
+      if (this->confirmedValid_ == true) {
+        this->state = this->confirmedState_;
+        this->speed = this->confirmedSpeed_;
+        this->publish_state();
+        this->publish_[PublishFan].mark(this->fanStateKey(), this->clock_->millis());
+      }
+      this->requestQuery();
+    }
+  }
+
+  this->commandCallback_.call(outcome);
+}
+
+void ZehnderRF::commandTrack(const uint16_t commandId) {
+  const uint32_t now = this->clock_->millis();
+  uint8_t oldest = 0;
+  uint8_t i;
+
+  for (i = 0; i < COMMAND_TRACK_SIZE; ++i) {
+    if (this->openCommands_[i].id == 0) {
+      break;
+    }
+    if ((now - this->openCommands_[i].submitTime) > (now - this->openCommands_[oldest].submitTime)) {
+      oldest = i;
+    }
+  }
+
+  if (i == COMMAND_TRACK_SIZE) {
+    // More open commands than the queues hold, so the oldest lost its outcome; report it now to make room
+    i = oldest;
+    this->commandExpire(i);
+  }
+
+  this->openCommands_[i].id = commandId;
+  this->openCommands_[i].submitTime = now;
+}
+
+bool ZehnderRF::commandUntrack(const uint16_t commandId) {
+  uint8_t i;
+
+  for (i = 0; i < COMMAND_TRACK_SIZE; ++i) {
+    if (this->openCommands_[i].id == commandId) {
+      this->openCommands_[i].id = 0;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ZehnderRF::commandExpire(const uint8_t index) {
+  CommandOutcome outcome;
+
+  // The outcome was lost on the way; every command gets one, so report a timeout
+  ESP_LOGW(TAG, "No outcome for command %u", this->openCommands_[index].id);
+  ++this->commandStats_.lost;
+  outcome.id = this->openCommands_[index].id;
+  outcome.result = CommandTimeout;
+  outcome.retries = 0;
+  outcome.latency = this->clock_->millis() - this->openCommands_[index].submitTime;
+  this->commandNotify(outcome);
+}
+
+void ZehnderRF::setPending(const uint16_t commandId) {
+  this->pendingCommand_ = commandId;
+  if (this->pendingSensor_ != NULL) {
+    this->pendingSensor_->publish_state(commandId != 0);
+  }
+}
+
+void ZehnderRF::pendingCheck(void) {
+  const uint32_t now = this->clock_->millis();
+  uint8_t i;
+
+  // Any command, from control(), a service, the schedule or demand; the pending one is rolled back on its timeout
+  for (i = 0; i < COMMAND_TRACK_SIZE; ++i) {
+    if ((this->openCommands_[i].id != 0) &&
+        (deadlinePassed(now, this->openCommands_[i].submitTime, COMMAND_OUTCOME_TIMEOUT) == true)) {
+      this->commandExpire(i);
+    }
+  }
+}
+
+void ZehnderRF::applyConfirmed(void) {
+  if (this->confirmedValid_ == false) {
+    return;
+  }
+
+  this->state = this->confirmedState_;
+  this->speed = this->confirmedSpeed_;
+  if (this->publish_[PublishFan].offer(this->fanStateKey(), this->clock_->millis()) == true) {
+    this->publish_state();
+  }
+}
+
+void ZehnderRF::requestQuery(void) {
+  RadioCommand command;
+
+  if (this->radioTask_ == false) {
+    if (this->state_ == StateIdle) {
+      this->queryDevice();
+    }
+    return;
+  }
+
+  command.type = RadioCommandQuery;
+  if (this->radioCommands_.push(command) == false) {
+    ESP_LOGW(TAG, "Radio command queue full, dropping query");
+  }
+}
+
+const char *ZehnderRF::commandResultToStr(const CommandResult result) {
+  switch (result) {
+    case CommandSuccess:
+      return "success";
+    case CommandTimeout:
+      return "timeout";
+    case CommandReplaced:
+      return "replaced";
+    case CommandRejected:
+      return "rejected";
+    default:
+      return "unknown";
+  }
+}
+
+void ZehnderRF::updateFanSettings(const uint8_t speed, const uint8_t voltage, const uint8_t timer) {
+  RadioEvent event;
+
+  ESP_LOGD(TAG, "Received fan settings; speed: 0x%02X voltage: %i timer: %i", speed, voltage, timer);
+
+  if (this->radioTask_ == false) {
+    this->publishFanSettings(speed, voltage, timer);
+    return;
+  }
+
+  // Entity state is only published from the main loop
+  event.type = RadioEventFanSettings;
+  event.speed = speed;
+  event.voltage = voltage;
+  event.timer = timer;
+  if (this->radioEvents_.push(event) == false) {
+    ESP_LOGW(TAG, "Radio event queue full, dropping fan settings");
+  }
+}
+
+void ZehnderRF::publishFanSettings(const uint8_t speed, const uint8_t voltage, const uint8_t timer) {
+  if (this->speedMode_ == SpeedModeVoltage) {
+    this->confirmedState_ = voltage > 0;
+    this->confirmedSpeed_ = voltage;
+  } else {
+    this->confirmedState_ = speed > 0;
+    this->confirmedSpeed_ = speed;
+  }
+  this->confirmedValid_ = true;
+
+  // While a requested state is pending, keep showing it; the command outcome decides
+  if (this->pendingCommand_ == 0) {
+    this->applyConfirmed();
+  }
+
+  this->publishSensor(this->voltageSensor_, PublishVoltage, voltage / 10.0f);
+  this->publishSensor(this->timerSensor_, PublishTimer, timer);
+}
+
+void ZehnderRF::publishSensor(sensor::Sensor *const pSensor, const PublishEntity entity, const float value) {
+  if ((pSensor != NULL) && (this->publish_[entity].offer(value, this->clock_->millis()) == true)) {
+    pSensor->publish_state(value);
+  }
+}
+
+uint32_t ZehnderRF::publishedSensors(const bool suppressed) const {
+  uint32_t count = 0;
+  uint8_t i;
+
+  for (i = PublishFan + 1; i < PublishNrOf; ++i) {
+    count += suppressed ? this->publish_[i].getSuppressed() : this->publish_[i].getPublished();
+  }
+
+  return count;
+}
+
+void ZehnderRF::publishDue(void) {
+  const uint32_t now = this->clock_->millis();
+  sensor::Sensor *const sensors[PublishNrOf] = {NULL,
+                                                this->voltageSensor_,
+                                                this->timerSensor_,
+                                                this->ramUsageSensor_,
+                                                this->networkDevicesSensor_,
+                                                this->txPowerSensor_,
+                                                this->radioOnSensor_};
+  uint8_t i;
+
+  // Held back changes and heartbeats
+  if (this->publish_[PublishFan].due(now) == true) {
+    this->publish_state();
+  }
+  for (i = PublishFan + 1; i < PublishNrOf; ++i) {
+    if ((sensors[i] != NULL) && (this->publish_[i].due(now) == true)) {
+      sensors[i]->publish_state(this->publish_[i].get());
+    }
+  }
+}
+
+void ZehnderRF::powerRun(void) {
+  const uint32_t now = this->clock_->millis();
+  nrf905::BusCounters before;
+  nrf905::BusCounters after;
+
+  // Pairing listens all the time; the RF layer wakes the radio again for every frame it sends
+  if ((this->radioPower_ == RadioPowerAlwaysOn) || (this->state_ != StateIdle) || (this->transactionCount_ > 0) ||
+      (this->rfState_ != RfStateIdle) || (this->txStaged_ == true)) {
+    return;
+  }
+
+  this->rf_->getBusCounters(&before);
+  if (this->rf_->getMode() == nrf905::PowerDown) {
+    // Open the next receive window, early by the wake lead
+    if ((this->radioPower_ == RadioPowerDutyCycle) &&
+        (deadlinePassed(now, this->powerTime_, this->rxPeriod_ - this->rxWindow_ - RADIO_WAKE_LEAD) == true)) {
+      this->rf_->setMode(nrf905::Receive);
+      this->powerTime_ = now;
+    }
+  } else if ((this->radioPower_ == RadioPowerDown) ||
+             (deadlinePassed(now, this->powerTime_, RADIO_WAKE_LEAD + this->rxWindow_) == true)) {
+    // A frame coming in keeps the window open until it is received
+    if (this->rf_->airwayBusy() == false) {
+      this->rf_->setMode(nrf905::PowerDown);
+      this->powerTime_ = now;
+    }
+  }
+
+  // The power policy switches on its own clock; frames sent pay for their own wake-up in rfLoad()
+  this->rf_->getBusCounters(&after);
+  this->busPassive_.pinWrites += after.pinWrites - before.pinWrites;
+}
+
+void ZehnderRF::radioOnPublish(void) {
+  const uint32_t now = this->clock_->millis();
+  uint32_t modeTimes[NRF905_MODE_COUNT];
+  uint32_t on;
+
+  // Mode times are kept by the radio side; a sample taken while it switches is off by one step at most
+  this->rf_->getModeTimes(modeTimes);
+  on = modeTimes[nrf905::Receive] + modeTimes[nrf905::Transmit];
+
+  this->publishSensor(this->radioOnSensor_, PublishRadioOn,
+                      ((on - this->radioOnLast_) * 100.0f) / (now - this->radioOnTime_));
+
+  this->radioOnLast_ = on;
+  this->radioOnTime_ = now;
+}
+
+void ZehnderRF::discoveryStart(void) {
+  (void) memset(this->idsInUse_, 0, sizeof(this->idsInUse_));
+
+  if (this->transactionStart(&ZehnderRF::flowDiscovery) != NULL) {
+    this->state_ = StateDiscovery;
+  }
+}
+
+ZehnderRF::Transaction *ZehnderRF::transactionStart(const Flow flow) {
+  Transaction *pTr = NULL;
+
+  static_assert(sizeof(Transaction) <= TRANSACTION_MAX_SIZE, "Transaction state too large");
+
+  if (this->transactionCount_ >= TRANSACTION_SLOTS) {
+    ESP_LOGW(TAG, "Transaction queue full");
+  } else {
+    pTr = &this->transactions_[(this->transactionHead_ + this->transactionCount_) % TRANSACTION_SLOTS];
+    (void) memset(pTr, 0, sizeof(Transaction));
+    pTr->flow = flow;
+    pTr->startTime = this->clock_->millis();
+    this->radioIdle_ = false;
+
+    if (this->transactionCount_ == 0) {
+      this->busCost(&this->busStart_);
+      this->busFrames_ = 0;
+    }
+    ++this->transactionCount_;
+  }
+
+  return pTr;
+}
+
+void ZehnderRF::transactionRun(void) {
+  Transaction *pTr;
+
+  MEMORY_STACK_SAMPLE();
+
+  // Commands queued at boot wait for the end of startup, which switches the radio to the fan network
+  if (this->state_ == StateStartup) {
+    return;
+  }
+
+  while (this->transactionCount_ > 0) {
+    pTr = &this->transactions_[this->transactionHead_];
+    if ((this->*(pTr->flow))(pTr) == TransactionWaiting) {
+      break;
+    }
+
+    ESP_LOGV(TAG, "Transaction done in %u ms", this->clock_->millis() - pTr->startTime);
+    this->busCheck();
+
+    // Release slot; the next transaction starts right away
+    this->transactionHead_ = (this->transactionHead_ + 1) % TRANSACTION_SLOTS;
+    --this->transactionCount_;
+  }
+}
+
+void ZehnderRF::busCost(BusCost *const pCost) {
+  nrf905::BusCounters counters;
+  uint32_t duplicates;
+  uint8_t op;
+
+  this->rf_->getBusCounters(&counters);
+  duplicates = this->rf_->getRxDuplicates();
+
+  // Status polls scale with wait time, not with work done; leave them out
+  pCost->transfers = 0;
+  pCost->bytes = 0;
+  for (op = nrf905::SpiOpStatus + 1; op < nrf905::SpiOpNrOf; ++op) {
+    pCost->transfers += counters.transfers[op];
+    pCost->bytes += counters.bytes[op];
+  }
+  pCost->pinWrites = counters.pinWrites;
+
+  // So do frames on the air that no transaction waited for, repeats the radio dropped included, and the pin writes
+  // of the power policy; they depend on traffic and time, not on the frames sent
+  pCost->transfers -= this->busPassive_.transfers + duplicates;
+  pCost->bytes -= this->busPassive_.bytes + (duplicates * sizeof(nrf905::Buffer));
+  pCost->pinWrites -= this->busPassive_.pinWrites;
+}
+
+void ZehnderRF::busCheck(void) {
+  BusCost cost;
+  uint8_t frames;
+
+  this->busCost(&cost);
+  cost.transfers -= this->busStart_.transfers;
+  cost.bytes -= this->busStart_.bytes;
+  cost.pinWrites -= this->busStart_.pinWrites;
+  frames = this->busFrames_ > 0 ? this->busFrames_ : 1;
+
+  ESP_LOGV(TAG, "Bus cost: %u frames, %u transfers, %u bytes, %u pin writes", this->busFrames_, cost.transfers,
+           cost.bytes, cost.pinWrites);
+  if ((cost.transfers > (BUS_BUDGET_TRANSFERS * frames)) || (cost.bytes > (BUS_BUDGET_BYTES * frames)) ||
+      (cost.pinWrites > (BUS_BUDGET_PIN_WRITES * frames))) {
+    ESP_LOGW(TAG, "Bus budget exceeded: %u frames took %u transfers, %u bytes, %u pin writes", this->busFrames_,
+             cost.transfers, cost.bytes, cost.pinWrites);
+    ++this->busOverruns_;
+  }
+
+  // Next transaction in the queue starts from here
+  this->busStart_.transfers += cost.transfers;
+  this->busStart_.bytes += cost.bytes;
+  this->busStart_.pinWrites += cost.pinWrites;
+  this->busFrames_ = 0;
+}
+
+void ZehnderRF::transactionSend(Transaction *const pTr, const int8_t rxRetries) {
+  pTr->rxTimeout = false;
+  (void) this->startTransmit(this->_txFrame, rxRetries);
+}
+
+Result ZehnderRF::startTransmit(const uint8_t *const pData, const int8_t rxRetries) {
+  Result result = ResultOk;
+
+  if (this->rfState_ == RfStateIdle) {
+    this->rfLoad(pData, rxRetries);
+  } else if (this->rfCanSend() == true) {
+    // A fire-and-forget frame is still going out; stage this one to follow it directly
+    (void) memcpy(this->txStagedFrame_, pData, FAN_FRAMESIZE);
+    this->txStagedRetries_ = rxRetries;
+    this->txStaged_ = true;
+  } else {
+    ESP_LOGW(TAG, "TX still ongoing");
+    result = ResultBusy;
+  }
+
+  return result;
+}
+
+bool ZehnderRF::rfCanSend(void) {
+  return (this->rfState_ == RfStateIdle) ||
+         ((this->retries_ < 0) && (this->txStaged_ == false) &&
+          ((this->rfState_ == RfStateWaitAirwayFree) || (this->rfState_ == RfStateTxBusy)));
+}
+
+void ZehnderRF::rfTimeout(void) {
+  if (this->transactionCount_ > 0) {
+    this->transactions_[this->transactionHead_].rxTimeout = true;
+    this->transactionRun();
+  }
+}
+
+void ZehnderRF::rfLoad(const uint8_t *const pData, const int8_t rxRetries) {
+  const RfFrame *const pFrame = (RfFrame *) pData;
+
+  this->applyTxPower(pFrame->rx_type, pFrame->rx_id, rxRetries);
+
+  this->retries_ = rxRetries;
+  this->rf_->writeTxPayload(pData, FAN_FRAMESIZE);  // Use framesize
+  if (this->busFrames_ < UINT8_MAX) {
+    ++this->busFrames_;
+  }
+
+  // Registers are accessible in power down; only wake the radio once the payload is in
+  if (this->rf_->getMode() == nrf905::PowerDown) {
+    this->rf_->setMode(nrf905::Receive);
+    this->radioWakeTime_ = this->clock_->millis();
+  }
+
+  this->rfState_ = RfStateWaitAirwayFree;
+  this->airwayFreeWaitTime_ = this->clock_->millis();
+}
+
+void ZehnderRF::applyTxPower(const uint8_t type, const uint8_t id, const int8_t rxRetries) {
+  int8_t power;
+
+  this->txPeerType_ = type;
+  this->txPeerId_ = id;
+  this->txRetriesStart_ = rxRetries;
+
+  if (this->txPowerAdaptive_ == false) {
+    return;
+  }
+
+  // Only frames to one device that answers say something about the link; everything else goes at full power
+  power = ((rxRetries >= 0) && (type != FAN_TYPE_BROADCAST) && (id != 0x00)) ? this->txPower_.getPower(type, id)
+                                                                            : TX_POWER_MAX;
+
+  this->setTxPower(power);
+}
+
+void ZehnderRF::setTxPower(const int8_t power) {
+  nrf905::Config rfConfig;
+
+  rfConfig = this->rf_->getConfig();
+  if (rfConfig.tx_power != power) {
+    rfConfig.tx_power = power;
+    this->rf_->updateConfig(&rfConfig);
+    this->publishTxPower(power);
+  }
+}
+
+void ZehnderRF::publishTxPower(const int8_t power) {
+  RadioEvent event;
+
+  if (this->radioTask_ == false) {
+    this->publishSensor(this->txPowerSensor_, PublishTxPower, power);
+    return;
+  }
+
+  event.type = RadioEventTxPower;
+  event.txPower = power;
+  if (this->radioEvents_.push(event) == false) {
+    ESP_LOGW(TAG, "Radio event queue full, dropping TX power");
+  }
+}
+
+void ZehnderRF::rfComplete(void) {
+  this->txRetriesUsed_ =
+      ((this->txRetriesStart_ >= 0) && (this->retries_ >= 0)) ? this->txRetriesStart_ - this->retries_ : 0;
+  if ((this->txPowerAdaptive_ == true) && (this->txRetriesStart_ >= 0) && (this->retries_ >= 0)) {
+    if (this->txPower_.report(this->txPeerType_, this->txPeerId_, this->txRetriesStart_ - this->retries_, true,
+                              this->clock_->millis()) == true) {
+      ESP_LOGD(TAG, "TX power to 0x%02X/0x%02X now %d dBm", this->txPeerType_, this->txPeerId_,
+               this->txPower_.getPower(this->txPeerType_, this->txPeerId_));
+    }
+  }
+  this->retries_ = -1;  // Disable this->retries_
+  this->rfState_ = RfStateIdle;
+}
+
+void ZehnderRF::rfHandler(void) {
+  switch (this->rfState_) {
+    case RfStateIdle:
+      break;
+
+    case RfStateWaitAirwayFree:
+      if (deadlinePassed(this->clock_->millis(), this->airwayFreeWaitTime_, 5000) == true) {
+        ESP_LOGW(TAG, "Airway too busy, giving up");
+        this->rfState_ = RfStateIdle;
+        this->txStaged_ = false;  // The staged frame's transaction gets the timeout
+
+        this->rfTimeout();
+      } else if (((this->clock_->millis() - this->radioWakeTime_) >= RADIO_WAKE_LEAD) &&
+                 (this->rf_->airwayBusy() == false)) {
+        // Carrier detect only means something once the radio is up and listening
+        ESP_LOGD(TAG, "Start TX");
         this->rf_->startTx(FAN_TX_FRAMES, nrf905::Receive);  // After transmit, wait for response
 
+        this->txStartTime_ = this->clock_->millis();
         this->rfState_ = RfStateTxBusy;
       }
       break;
 
     case RfStateTxBusy:
+      // Watchdog; TX ready should follow within a few ms
+      if (deadlinePassed(this->clock_->millis(), this->txStartTime_, MAX_TRANSMIT_TIME) == true) {
+        this->rfRecoverTx();
+      }
       break;
 
     case RfStateRxWait:
-      if ((this->retries_ >= 0) && ((millis() - this->msgSendTime_) > FAN_REPLY_TIMEOUT)) {
+      if ((this->retries_ >= 0) &&
+          (deadlinePassed(this->clock_->millis(), this->msgSendTime_, FAN_REPLY_TIMEOUT) == true)) {
         ESP_LOGD(TAG, "Receive timeout");
 
         if (this->retries_ > 0) {
           --this->retries_;
           ESP_LOGD(TAG, "No data received, retry again (left: %u)", this->retries_);
 
+          if ((this->txPowerAdaptive_ == true) && (this->txRetriesStart_ >= 0)) {
+            // The reply may have been lost to the reduced power; step up for every retry
+            this->setTxPower(this->txPower_.getPower(this->txPeerType_, this->txPeerId_,
+                                                     this->txRetriesStart_ - this->retries_));
+          }
+
           this->rfState_ = RfStateWaitAirwayFree;
-          this->airwayFreeWaitTime_ = millis();
+          this->airwayFreeWaitTime_ = this->clock_->millis();
         } else if (this->retries_ == 0) {
           // Oh oh, ran out of options
 
           ESP_LOGD(TAG, "No messages received, giving up now...");
-          if (this->onReceiveTimeout_ != NULL) {
-            this->onReceiveTimeout_();
+
+          if ((this->txPowerAdaptive_ == true) && (this->txRetriesStart_ >= 0)) {
+            (void) this->txPower_.report(this->txPeerType_, this->txPeerId_, this->txRetriesStart_, false,
+                                         this->clock_->millis());
           }
 
           // Back to idle
           this->rfState_ = RfStateIdle;
+
+          this->rfTimeout();
         }
       }
       break;
@@ -649,5 +1875,57 @@ void ZehnderRF::rfHandler(void) {
   }
 }
 
+void ZehnderRF::rfRecoverTx(void) {
+  TxRecoveryStats *const pStats = &this->txRecoveryStats_;
+
+  if (this->txRecovery_ == TxRecoveryNone) {
+    ++pStats->stalls;
+    this->txRecoveryStartTime_ = this->txStartTime_;
+  }
+
+  switch (this->txRecovery_) {
+    case TxRecoveryNone:
+      ESP_LOGW(TAG, "No TX ready within %u ms, re-toggle radio mode", MAX_TRANSMIT_TIME);
+      this->rf_->setMode(nrf905::Idle);
+
+      ++pStats->modeToggles;
+      this->txRecovery_ = TxRecoveryModeToggle;
+      break;
+
+    case TxRecoveryModeToggle:
+      ESP_LOGW(TAG, "Still no TX ready, rewrite radio config");
+      this->rf_->setMode(nrf905::Idle);
+      this->rf_->restoreRegisters();
+
+      ++pStats->configRewrites;
+      this->txRecovery_ = TxRecoveryConfigRewrite;
+      break;
+
+    case TxRecoveryConfigRewrite:
+      ESP_LOGW(TAG, "Still no TX ready, power cycle radio");
+      this->rf_->powerCycle();
+
+      ++pStats->powerCycles;
+      this->txRecovery_ = TxRecoveryPowerCycle;
+      break;
+
+    default:
+      ESP_LOGE(TAG, "Radio does not recover, giving up this transmit");
+      this->rf_->setMode(nrf905::Idle);
+
+      ++pStats->failures;
+      this->txRecovery_ = TxRecoveryNone;
+      this->rfState_ = RfStateIdle;
+      this->txStaged_ = false;
+
+      this->rfTimeout();
+      return;
+  }
+
+  // Retry the transmit with the payload still in the radio
+  this->rf_->startTx(FAN_TX_FRAMES, nrf905::Receive);
+  this->txStartTime_ = this->clock_->millis();
+}
+
 }  // namespace zehnder
 }  // namespace esphome
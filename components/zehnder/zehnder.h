@@ -2,10 +2,26 @@
 #define __COMPONENT_ZEHNDER_H__
 
 #include "esphome/core/component.h"
+#include "esphome/core/defines.h"
 #include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
 #include "esphome/components/spi/spi.h"
+#include "esphome/components/binary_sensor/binary_sensor.h"
 #include "esphome/components/fan/fan_state.h"
+#include "esphome/components/sensor/sensor.h"
+#ifdef USE_TIME
+#include "esphome/components/time/real_time_clock.h"
+#endif
 #include "esphome/components/nrf905/nRF905.h"
+#include "esphome/components/nrf905/radio_thread.h"
+#include "esphome/components/nrf905/spsc_queue.h"
+#include "deadline.h"
+#include "demand.h"
+#include "publish.h"
+#include "repeater.h"
+#include "schedule.h"
+#include "tx_power.h"
+#include "transaction.h"
 
 namespace esphome {
 namespace zehnder {
@@ -50,12 +66,123 @@ enum {
   FAN_SPEED_MAX = 0x04
 };  // Max:    100% or 10.0 volt
 
+#define FAN_VOLTAGE_MAX 100  // Voltage is set and reported in 0.1 volt steps, 100 = 10.0 volt
+
 #define NETWORK_LINK_ID 0xA55A5AA5
 #define NETWORK_DEFAULT_ID 0xE7E7E7E7
 #define FAN_JOIN_DEFAULT_TIMEOUT 10000
 
+#define PAIRING_ATTEMPTS 5                       // Join attempts before pairing times out
+#define PAIRING_LISTEN_TIME 2000                 // Listen before each attempt, plus up to as much jitter (ms)
+#define PAIRING_FAN_LISTEN_TIME 1000             // Listen on the fan network before joining it (ms)
+#define PAIRING_BACKOFF 2000                     // Wait before the second attempt, doubled every attempt (ms)
+#define PAIRING_BACKOFF_MAX 32000                // Upper bound of the backoff, before jitter (ms)
+#define PAIRING_RETRY_INTERVAL (15 * 60 * 1000)  // Start pairing again this long after a timeout (ms)
+
+#define TRANSACTION_SLOTS 4      // Number of transactions that can be in flight or queued
+#define TRANSACTION_MAX_SIZE 48  // Upper bound for the memory of one transaction (bytes)
+
+#define INVENTORY_SIZE 16      // Devices kept in the network inventory
+#define INVENTORY_WINDOW 3000  // Collect replies to an inventory sweep for this long (ms)
+
+#define SCHEDULE_CHECK_INTERVAL 1000  // Compare the time against the next schedule entry this often (ms)
+#define SCHEDULE_RESYNC 3600          // Look up the next entry again after this long, for DST and clock changes (s)
+#define SCHEDULE_LATE_LIMIT 60        // Skip an entry instead of running it when found this much later (s)
+
+#define RADIO_QUEUE_SIZE 8   // Commands to and events from the radio task
+#define RADIO_TASK_PERIOD 1  // Radio task poll interval (ms), rounded up to whole FreeRTOS ticks
+
+#define PUBLISH_CHECK_INTERVAL 250  // Look for held back changes and heartbeats this often (ms)
+
+// Longest a set speed can take: waiting behind the other slots, then all retries of its own (ms)
+#define COMMAND_OUTCOME_TIMEOUT (TRANSACTION_SLOTS * (FAN_TX_RETRIES + 1) * FAN_REPLY_TIMEOUT + 10000)
+
+// Commands without an outcome yet: in the radio command queue, in a transaction, or their outcome in the event queue
+#define COMMAND_TRACK_SIZE ((2 * RADIO_QUEUE_SIZE) + TRANSACTION_SLOTS)
+
+// Power up, then listen long enough for carrier detect (ms). Set by fan.py, which checks the receive window against it
+#ifndef ZEHNDER_RADIO_WAKE_LEAD
+#define ZEHNDER_RADIO_WAKE_LEAD (POWER_UP_DELAY + 2)
+#endif
+#define RADIO_WAKE_LEAD ZEHNDER_RADIO_WAKE_LEAD
+#define RADIO_ON_INTERVAL 60000  // Radio on-time sensor period (ms)
+
+#define BUS_BUDGET_TRANSFERS 8    // SPI transfers per frame sent; status polls and frames no one asked for excluded
+#define BUS_BUDGET_BYTES 240      // SPI bytes per frame sent; status polls and frames no one asked for excluded
+#define BUS_BUDGET_PIN_WRITES 14  // Mode pin level changes per frame sent; duty cycle switching excluded
+
 typedef enum { ResultOk, ResultBusy, ResultFailure } Result;
 
+typedef enum {
+  SpeedModePreset,   // Fan speed selects one of the presets (FAN_FRAME_SETSPEED)
+  SpeedModeVoltage,  // Fan speed is a percentage of the 0-10 volt control (FAN_FRAME_SETVOLTAGE)
+} SpeedMode;
+
+typedef enum {
+  RadioPowerAlwaysOn,   // Receive continuously; hears every unsolicited frame
+  RadioPowerDown,       // Power down between transactions; only replies to our own frames are heard
+  RadioPowerDutyCycle,  // Power down between transactions, with a short receive window every period
+} RadioPower;
+
+typedef struct {
+  uint32_t stalls;            // Number of transmits without TX ready
+  uint32_t modeToggles;       // Recovery tier 1: re-toggle mode
+  uint32_t configRewrites;    // Recovery tier 2: rewrite config registers
+  uint32_t powerCycles;       // Recovery tier 3: power cycle radio
+  uint32_t recovered;         // Number of successful recoveries
+  uint32_t failures;          // Number of times all tiers failed
+  uint32_t lastRecoveryTime;  // Time from stall to TX ready of last recovery (ms)
+  uint32_t maxRecoveryTime;   // Longest time from stall to TX ready (ms)
+} TxRecoveryStats;
+
+typedef struct {
+  uint32_t attempts;      // Join attempts, including those skipped because the link channel was in use
+  uint32_t timeouts;      // Pairing runs that used up all attempts
+  uint32_t lastDuration;  // Duration of the last pairing run, successful or not (ms)
+  uint32_t idConflicts;   // Frames from another device using our device ID
+} PairingStats;
+
+typedef enum {
+  CommandSuccess,   // Fan reported the new setting
+  CommandTimeout,   // No reply after all retries
+  CommandReplaced,  // A newer setting took its place before it was sent
+  CommandRejected,  // Not paired, or no room to queue it
+} CommandResult;
+
+typedef struct {
+  uint16_t id;           // ID returned by setSpeed() or setVoltage()
+  CommandResult result;  // Outcome
+  uint8_t retries;       // Retransmissions before the fan replied
+  uint32_t latency;      // From queueing the setting to the outcome (ms)
+} CommandOutcome;
+
+typedef struct {
+  uint32_t success;
+  uint32_t timeouts;
+  uint32_t replaced;
+  uint32_t rejected;
+  uint32_t lost;        // Outcome never arrived; reported as a timeout after COMMAND_OUTCOME_TIMEOUT
+  uint32_t maxLatency;  // Slowest successful command (ms)
+} CommandStats;
+
+typedef enum {
+  PublishFan,             // Fan state and speed
+  PublishVoltage,         // Voltage sensor
+  PublishTimer,           // Timer sensor
+  PublishRamUsage,        // RAM usage sensor
+  PublishNetworkDevices,  // Network devices sensor
+  PublishTxPower,         // TX power sensor
+  PublishRadioOn,         // Radio on-time sensor
+
+  PublishNrOf  // Keep last
+} PublishEntity;
+
+typedef struct {
+  uint8_t type;       // Device type (FAN_TYPE_...)
+  uint8_t id;         // Device ID
+  uint32_t lastSeen;  // Time a frame from this device was last received (ms)
+} InventoryEntry;
+
 class ZehnderRF : public Component, public fan::Fan {
  public:
   ZehnderRF();
@@ -66,6 +193,57 @@ class ZehnderRF : public Component, public fan::Fan {
   void set_rf(nrf905::nRF905 *const pRf) { rf_ = pRf; }
 
   void set_update_interval(const uint32_t interval) { interval_ = interval; }
+  void set_clock(nrf905::Clock *const pClock) { clock_ = pClock; }
+  void set_speed_mode(const SpeedMode mode) { speedMode_ = mode; }
+  void set_voltage_sensor(sensor::Sensor *const pSensor) { voltageSensor_ = pSensor; }
+  void set_timer_sensor(sensor::Sensor *const pSensor) { timerSensor_ = pSensor; }
+  // On while a state set from the UI has not been confirmed by the fan yet
+  void set_pending_sensor(binary_sensor::BinarySensor *const pSensor) { pendingSensor_ = pSensor; }
+  // Applies to the fan state and every sensor of the component
+  void set_publish_policy(const uint32_t minInterval, const uint32_t heartbeat);
+  void set_ram_usage_sensor(sensor::Sensor *const pSensor) { ramUsageSensor_ = pSensor; }
+  void set_radio_task(const bool radioTask) { radioTask_ = radioTask; }
+  void set_network_devices_sensor(sensor::Sensor *const pSensor) { networkDevicesSensor_ = pSensor; }
+
+  // Schedule; entries from the configuration, replaced by a table saved at runtime as long as the configuration is
+  // the same
+#ifdef USE_TIME
+  void set_time(time::RealTimeClock *const pTime) { time_ = pTime; }
+#endif
+  void add_schedule_entry(const uint8_t days, const uint8_t hour, const uint8_t minute, const uint8_t speed,
+                          const uint8_t timer);
+  bool setScheduleEntry(const uint8_t index, const uint8_t days, const uint8_t hour, const uint8_t minute,
+                        const uint8_t speed, const uint8_t timer);
+  bool clearScheduleEntry(const uint8_t index);
+  const Schedule &getSchedule(void) const { return this->schedule_; }
+
+  // Forward frames on our network that are addressed to other devices
+  void set_repeater(const bool enable) { repeaterEnabled_ = enable; }
+  void set_repeater_delay(const uint16_t min, const uint16_t max) { repeater_.set_delay(min, max); }
+  const RepeaterStats *getRepeaterStats(void) const { return this->repeater_.getStats(); }
+
+  // Radio power policy, traded against hearing frames we did not ask for
+  void set_radio_power(const RadioPower power) { radioPower_ = power; }
+  void set_rx_window(const uint16_t window, const uint32_t period) {
+    rxWindow_ = window;
+    rxPeriod_ = period;
+  }
+  void set_radio_on_sensor(sensor::Sensor *const pSensor) { radioOnSensor_ = pSensor; }
+
+  // Adaptive TX power
+  void set_tx_power_adaptive(const bool adaptive) { txPowerAdaptive_ = adaptive; }
+  void set_tx_power_min(const int8_t power) { txPower_.set_min_power(power); }
+  void set_tx_power_clean_streak(const uint8_t streak) { txPower_.set_clean_streak(streak); }
+  void set_tx_power_sensor(sensor::Sensor *const pSensor) { txPowerSensor_ = pSensor; }
+
+  // Demand control
+  void set_demand_sensor(sensor::Sensor *const pSensor) { demandSensor_ = pSensor; }
+  void set_demand_mode(const DemandMode mode) { demand_.set_mode(mode); }
+  void set_demand_setpoint(const float setpoint) { demand_.set_setpoint(setpoint); }
+  void set_demand_hysteresis(const float hysteresis) { demand_.set_hysteresis(hysteresis); }
+  void set_demand_gains(const float kp, const float ki) { demand_.set_gains(kp, ki); }
+  void set_demand_output_range(const uint8_t low, const uint8_t high) { demand_.set_output_range(low, high); }
+  void set_demand_min_dwell(const uint32_t ms) { demand_.set_min_dwell(ms); }
 
   void dump_config() override;
 
@@ -78,44 +256,226 @@ class ZehnderRF : public Component, public fan::Fan {
 
   float get_setup_priority() const override { return setup_priority::DATA; }
 
-  void setSpeed(const uint8_t speed, const uint8_t timer = 0);
+  // Both return a command ID; its outcome is reported to the command callbacks from the main loop
+  uint16_t setSpeed(const uint8_t speed, const uint8_t timer = 0);
+  uint16_t setVoltage(const uint8_t voltage);
+  void add_on_command_callback(std::function<void(const CommandOutcome &)> &&callback) {
+    this->commandCallback_.add(std::move(callback));
+  }
+  const CommandStats &getCommandStats(void) const { return this->commandStats_; }
+  static const char *commandResultToStr(const CommandResult result);
+
+  const TxRecoveryStats &getTxRecoveryStats(void) const { return this->txRecoveryStats_; }
+  const PairingStats &getPairingStats(void) const { return this->pairingStats_; }
+
+  // Network inventory; a sweep broadcasts a network query and collects the replies
+  void inventorySweep(void);
+  const InventoryEntry *getInventory(void) const { return this->inventory_; }
+  uint8_t getInventoryCount(void) const { return this->inventoryCount_; }
 
  protected:
   void queryDevice(void);
+  uint32_t pollInterval(void);
+  void inventoryStart(void);
+  void inventoryUpdate(const uint8_t type, const uint8_t id);
+  void publishInventory(const uint8_t count);
+  void applyTxPower(const uint8_t type, const uint8_t id, const int8_t rxRetries);
+  void setTxPower(const int8_t power);
+  void publishTxPower(const int8_t power);
+  void repeaterOffer(const uint8_t *const pData);
+  void repeaterRun(void);
+  void powerRun(void);
+  void radioOnPublish(void);
 
   uint8_t createDeviceID(void);
-  void discoveryStart(const uint8_t deviceId);
+  void markIdInUse(const uint8_t id) { this->idsInUse_[id / 8] |= (1 << (id % 8)); }
+  bool isIdInUse(const uint8_t id) const { return (this->idsInUse_[id / 8] & (1 << (id % 8))) != 0; }
+  void discoveryStart(void);
+
+  bool isPaired(void);
+  void setNetwork(const uint32_t networkId);
+
+  uint16_t submitSetting(const uint8_t value, const uint8_t timer, const bool voltage);
+  void queueSetting(const uint8_t value, const uint8_t timer, const bool voltage, const uint16_t commandId);
+  void commandDone(const uint16_t commandId, const CommandResult result, const uint8_t retries,
+                   const uint32_t startTime);
+  void commandNotify(const CommandOutcome &outcome);
+  void commandTrack(const uint16_t commandId);
+  bool commandUntrack(const uint16_t commandId);
+  void commandExpire(const uint8_t index);
+  void setPending(const uint16_t commandId);
+  void pendingCheck(void);
+  void applyConfirmed(void);
+  void requestQuery(void);
+  void scheduleLoad(void);
+  void scheduleSave(void);
+  void scheduleRun(void);
+  void updateFanSettings(const uint8_t speed, const uint8_t voltage, const uint8_t timer);
+  void publishFanSettings(const uint8_t speed, const uint8_t voltage, const uint8_t timer);
+  float fanStateKey(void) const { return (this->state ? 0x100 : 0) | (this->speed & 0xFF); }
+  void publishSensor(sensor::Sensor *const pSensor, const PublishEntity entity, const float value);
+  void publishDue(void);
+  uint32_t publishedSensors(const bool suppressed) const;
+
+  // Radio side of the component; runs in the main loop, or in the radio task when enabled
+  void radioStep(void);
+  void radioCommands(void);
+  void radioEvents(void);
+  void radioSnapshot(void);
+  void dumpTables(const InventoryEntry *const pInventory, const uint8_t inventoryCount,
+                  TxPowerController *const pTxPower);
+  void radioTaskStart(void);
+  void radioSleep(const uint32_t time);
+  bool radioAwake(void);
+  uint32_t radioIdleTime(void);
+
+  void demandUpdate(const float value);
+
+  uint32_t getRamUsage(void);
+
+  struct Transaction;
+  typedef TransactionStatus (ZehnderRF::*Flow)(Transaction *const pTr);
+
+  struct Transaction {
+    Flow flow;              // Flow running this transaction
+    uint16_t line;          // Flow resume point
+    bool rxTimeout;         // RF layer ran out of retries
+    bool rxUsed;            // Flow used the received frame without moving on
+    const uint8_t *pRx;     // Received frame; only valid while it is being dispatched
+    uint32_t startTime;     // Time the transaction started (ms)
+    union {
+      struct {
+        uint8_t speed;  // Preset, or voltage when 'voltage' is set
+        uint8_t timer;
+        bool voltage;
+        uint16_t commandId;
+      } setSpeed;
+      struct {
+        uint8_t attempt;
+        bool heard;         // Link channel was in use while listening
+        uint16_t waitTime;  // Listen or backoff time (ms)
+        uint32_t waitStart;
+      } discovery;
+      struct {
+        uint8_t replies;
+        uint32_t windowStart;
+      } inventory;
+    } param;
+  };
+
+  TransactionStatus flowDiscovery(Transaction *const pTr);
+  TransactionStatus flowQuery(Transaction *const pTr);
+  TransactionStatus flowSetSpeed(Transaction *const pTr);
+  TransactionStatus flowInventory(Transaction *const pTr);
+
+  bool pairingListen(Transaction *const pTr);
+  uint16_t pairingBackoff(const uint8_t attempt);
+  bool inventoryCollect(Transaction *const pTr);
+
+  Transaction *transactionStart(const Flow flow);
+  void transactionRun(void);
+  void transactionSend(Transaction *const pTr, const int8_t rxRetries);
+
+  Result startTransmit(const uint8_t *const pData, const int8_t rxRetries = -1);
+  bool rfCanSend(void);
+  void rfLoad(const uint8_t *const pData, const int8_t rxRetries);
 
-  Result startTransmit(const uint8_t *const pData, const int8_t rxRetries = -1,
-                       const std::function<void(void)> callback = NULL);
+  typedef struct {
+    uint32_t transfers;
+    uint32_t bytes;
+    uint32_t pinWrites;
+  } BusCost;
+  void busCost(BusCost *const pCost);
+  void busCheck(void);
+  void rfTimeout(void);
   void rfComplete(void);
   void rfHandler(void);
+  void rfRecoverTx(void);
   void rfHandleReceived(const uint8_t *const pData, const uint8_t dataLength);
 
   typedef enum {
     StateStartup,
     StateStartDiscovery,
-    StateDiscoveryWaitForLinkRequest,
-    StateDiscoveryWaitForJoinResponse,
-    StateDiscoveryJoinComplete,
+    StateDiscovery,
+    StatePairingTimeout,
 
     StateIdle,
-    StateWaitQueryResponse,
-    StateWaitSetSpeedResponse,
-    StateWaitSetSpeedConfirm,
 
     StateNrOf  // Keep last
   } State;
   State state_{StateStartup};
   int speed_count_{};
+  SpeedMode speedMode_{SpeedModePreset};
+  sensor::Sensor *voltageSensor_{NULL};
+  sensor::Sensor *timerSensor_{NULL};
+
+  // State requested through control() is shown right away and stays pending until the command has its outcome
+  uint16_t pendingCommand_{0};
+  bool confirmedValid_{false};
+  bool confirmedState_{false};
+  int confirmedSpeed_{0};
+  binary_sensor::BinarySensor *pendingSensor_{NULL};
+
+  sensor::Sensor *ramUsageSensor_{NULL};
+
+  PublishLimiter publish_[PublishNrOf];
+
+  sensor::Sensor *demandSensor_{NULL};
+  DemandController demand_;
 
   nrf905::nRF905 *rf_;
+  nrf905::Clock *clock_{&nrf905::systemClock};
   uint32_t interval_;
+  uint32_t startupTime_{0};
 
   uint8_t _txFrame[FAN_FRAMESIZE];
 
   ESPPreferenceObject pref_;
 
+  Schedule schedule_;
+  ESPPreferenceObject schedulePref_;
+  uint32_t scheduleVersion_{0};  // Hash of the configured table
+  bool scheduleStale_{true};     // Next entry needs to be looked up
+#ifdef USE_TIME
+  time::RealTimeClock *time_{NULL};
+  int8_t scheduleNext_{-1};   // Entry due next, -1 when none
+  time_t scheduleDue_{0};     // Time it is due
+  time_t scheduleLookup_{0};  // Time the next entry was looked up
+#endif
+
+  uint8_t idsInUse_[256 / 8]{};  // Device IDs heard while pairing
+  uint32_t pairingTimeoutTime_{0};
+  PairingStats pairingStats_{};
+
+  InventoryEntry inventory_[INVENTORY_SIZE];
+  uint8_t inventoryCount_{0};
+  sensor::Sensor *networkDevicesSensor_{NULL};
+
+  bool repeaterEnabled_{false};
+  Repeater repeater_;
+
+  // Radio side sleeps while nothing is in flight
+  bool radioIdle_{false};
+  uint32_t radioSleepStart_{0};
+  uint32_t radioSleepTime_{0};
+
+  RadioPower radioPower_{RadioPowerAlwaysOn};
+  uint16_t rxWindow_{50};      // Receive window in duty cycle mode, after the wake lead (ms)
+  uint32_t rxPeriod_{1000};    // Duty cycle period (ms)
+  uint32_t powerTime_{0};      // Start of the current receive window or power down period
+  uint32_t radioWakeTime_{0};  // Radio woke up from power down to send
+  sensor::Sensor *radioOnSensor_{NULL};
+  uint32_t radioOnTime_{0};  // Time of the last on-time sample
+  uint32_t radioOnLast_{0};  // RX and TX time at the last sample (ms)
+
+  bool txPowerAdaptive_{false};
+  TxPowerController txPower_;
+  sensor::Sensor *txPowerSensor_{NULL};
+  uint8_t txPeerType_{0};      // Peer of the frame being sent
+  uint8_t txPeerId_{0};
+  int8_t txRetriesStart_{-1};  // RX retries the frame was sent with
+  uint8_t txRetriesUsed_{0};   // Retransmissions of the last exchange that got its reply
+
   typedef struct {
     uint32_t fan_networkId;      // Fan (Zehnder/BUVA) network ID
     uint8_t fan_my_device_type;  // Fan (Zehnder/BUVA) device type
@@ -126,16 +486,21 @@ class ZehnderRF : public Component, public fan::Fan {
   Config config_;
 
   uint32_t lastFanQuery_{0};
-  std::function<void(void)> onReceiveTimeout_ = NULL;
+
+  Transaction transactions_[TRANSACTION_SLOTS];
+  uint8_t transactionHead_{0};
+  uint8_t transactionCount_{0};
+
+  // Bus cost of the head transaction, checked against the budget when it completes
+  BusCost busStart_{};
+  BusCost busPassive_{};  // Received frames no transaction used, duty cycle pin writes; not caused by frames sent
+  uint8_t busFrames_{0};
+  uint32_t busOverruns_{0};
 
   uint32_t msgSendTime_{0};
   uint32_t airwayFreeWaitTime_{0};
   int8_t retries_{-1};
 
-  uint8_t newSpeed{0};
-  uint8_t newTimer{0};
-  bool newSetting{false};
-
   typedef enum {
     RfStateIdle,            // Idle state
     RfStateWaitAirwayFree,  // wait for airway free
@@ -143,6 +508,80 @@ class ZehnderRF : public Component, public fan::Fan {
     RfStateRxWait,
   } RfState;
   RfState rfState_{RfStateIdle};
+
+  // Frame staged behind a fire-and-forget frame, started from TX ready
+  uint8_t txStagedFrame_[FAN_FRAMESIZE];
+  int8_t txStagedRetries_{-1};
+  bool txStaged_{false};
+
+  typedef enum {
+    TxRecoveryNone,
+    TxRecoveryModeToggle,
+    TxRecoveryConfigRewrite,
+    TxRecoveryPowerCycle,
+  } TxRecovery;
+  TxRecovery txRecovery_{TxRecoveryNone};
+  uint32_t txStartTime_{0};
+  uint32_t txRecoveryStartTime_{0};
+  TxRecoveryStats txRecoveryStats_{};
+
+  typedef enum {
+    RadioCommandSetting,    // Set speed or voltage
+    RadioCommandInventory,  // Start an inventory sweep
+    RadioCommandQuery,      // Query the fan settings now
+    RadioCommandSnapshot,   // Copy the tables for dump_config()
+  } RadioCommandType;
+
+  typedef struct {
+    RadioCommandType type;
+    uint8_t value;
+    uint8_t timer;
+    bool voltage;
+    uint16_t commandId;
+  } RadioCommand;
+
+  typedef enum {
+    RadioEventFanSettings,  // Fan reported its settings
+    RadioEventInventory,    // Inventory sweep done
+    RadioEventTxPower,      // TX power changed
+    RadioEventCommand,      // Setting command finished
+    RadioEventSnapshot,     // Tables copied to snapshot_
+  } RadioEventType;
+
+  typedef struct {
+    RadioEventType type;
+    uint8_t speed;
+    uint8_t voltage;
+    uint8_t timer;
+    uint8_t devices;  // Inventory size
+    int8_t txPower;   // dBm
+    CommandOutcome command;
+  } RadioEvent;
+
+  bool radioTask_{false};
+  nrf905::RadioThread radioThread_;
+  nrf905::SpscQueue<RadioCommand, RADIO_QUEUE_SIZE> radioCommands_;  // Main loop -> radio task
+  nrf905::SpscQueue<RadioEvent, RADIO_QUEUE_SIZE> radioEvents_;      // Radio task -> main loop
+
+  // Tables the radio task writes, copied by the task for dump_config(). Written on RadioCommandSnapshot only, read
+  // on RadioEventSnapshot only; the main loop asks for the next copy once it has read the last one.
+  struct {
+    InventoryEntry inventory[INVENTORY_SIZE];
+    uint8_t inventoryCount;
+    TxPowerController txPower;
+  } snapshot_;
+  bool snapshotDue_{false};      // Radio side; copy taken, event not queued yet
+  bool snapshotPending_{false};  // Main loop; asked for a copy, event not handled yet
+
+  uint16_t nextCommandId_{0};
+  // Main loop; every command handed out until its outcome is reported, so each one times out at most once
+  struct {
+    uint16_t id;          // 0 for a free slot
+    uint32_t submitTime;  // ms
+  } openCommands_[COMMAND_TRACK_SIZE]{};
+  CommandStats commandStats_{};
+  volatile uint32_t outcomeDrops_{0};  // Outcomes dropped on a full event queue; radio side only
+  CallbackManager<void(const CommandOutcome &)> commandCallback_;
 };
 
 }  // namespace zehnder
@@ -0,0 +1,24 @@
+#ifndef __TESTS_HOST_CHECK_H__
+#define __TESTS_HOST_CHECK_H__
+
+#include <stdio.h>
+
+/* Minimal checks for the host tests; each test is one executable that returns non-zero on the first failure. */
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      return 1; \
+    } \
+  } while (0)
+
+#define RUN(test) \
+  do { \
+    if (test() != 0) { \
+      printf("FAIL %s\n", #test); \
+      return 1; \
+    } \
+    printf("ok   %s\n", #test); \
+  } while (0)
+
+#endif /* __TESTS_HOST_CHECK_H__ */
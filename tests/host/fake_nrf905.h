@@ -0,0 +1,188 @@
+#ifndef __TESTS_HOST_FAKE_NRF905_H__
+#define __TESTS_HOST_FAKE_NRF905_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <functional>
+
+#include "esphome/core/hal.h"
+#include "esphome/components/spi/spi.h"
+#include "nrf905/nRF905.h"
+
+/* Pin of the host tests; it keeps its level, counts the writes that reach it and tells onWrite. Driven by the
+ * simulated chip, it calls the attached interrupt handler on the edges it was attached for. */
+class HostPin : public esphome::InternalGPIOPin {
+ public:
+  explicit HostPin(const uint8_t pin) : pin_(pin) {}
+
+  void setup() override {}
+  bool digital_read() override { return this->level; }
+  void digital_write(bool value) override {
+    const bool edge = value != this->level;
+
+    this->level = value;
+    ++this->writes;
+    if (this->onWrite) {
+      this->onWrite();
+    }
+    if ((edge == true) && (this->isr_ != NULL) &&
+        ((this->isrType_ == esphome::gpio::INTERRUPT_ANY_EDGE) ||
+         ((this->isrType_ == esphome::gpio::INTERRUPT_RISING_EDGE) && (value == true)) ||
+         ((this->isrType_ == esphome::gpio::INTERRUPT_FALLING_EDGE) && (value == false)))) {
+      ++this->interrupts;
+      this->isr_(this->isrArg_);
+    }
+  }
+  uint8_t get_pin() const override { return this->pin_; }
+  bool is_inverted() const override { return false; }
+
+  bool level{false};
+  uint32_t writes{0};
+  uint32_t interrupts{0};
+  std::function<void(void)> onWrite;
+
+ protected:
+  void attach_interrupt(void (*func)(void *), void *arg, esphome::gpio::InterruptType type) const override {
+    this->isr_ = func;
+    this->isrArg_ = arg;
+    this->isrType_ = type;
+  }
+
+  uint8_t pin_;
+  mutable void (*isr_)(void *){NULL};
+  mutable void *isrArg_{NULL};
+  mutable esphome::gpio::InterruptType isrType_{esphome::gpio::INTERRUPT_ANY_EDGE};
+};
+
+/* nRF905 as seen from the SPI bus and the mode pins. It keeps the registers, reports DR and AM in the status byte,
+ * and follows the datasheet for DR: a frame sent in TX mode sets it, leaving TX mode or reading the RX payload
+ * clears it. The test decides when a frame on air is complete (txDone) or a frame arrives (receive). */
+class FakeNrf905 {
+ public:
+  FakeNrf905() {
+    hostSpi = [this](uint8_t *const data, const size_t length) { this->transfer(data, length); };
+    this->ce.onWrite = [this](void) { this->follow(); };
+    this->pwr.onWrite = [this](void) { this->follow(); };
+    this->txen.onWrite = [this](void) { this->follow(); };
+  }
+  ~FakeNrf905() { hostSpi = nullptr; }
+
+  // DR and AM are optional on the board, as on the real one
+  void attach(esphome::nrf905::nRF905 *const pRadio, const bool statusPins = false) {
+    pRadio->set_ce_pin(&this->ce);
+    pRadio->set_pwr_pin(&this->pwr);
+    pRadio->set_txen_pin(&this->txen);
+    if (statusPins == true) {
+      pRadio->set_dr_pin(&this->dr);
+      pRadio->set_am_pin(&this->am);
+    }
+  }
+
+  esphome::nrf905::Mode mode(void) const {
+    if (this->pwr.level == false) {
+      return esphome::nrf905::PowerDown;
+    }
+    if (this->ce.level == false) {
+      return esphome::nrf905::Idle;
+    }
+    return (this->txen.level == true) ? esphome::nrf905::Transmit : esphome::nrf905::Receive;
+  }
+
+  // Frame on air complete; only a radio in TX mode sends
+  bool txDone(void) {
+    if (this->mode() != esphome::nrf905::Transmit) {
+      return false;
+    }
+    (void) memcpy(this->sent, this->txPayload, NRF905_MAX_FRAMESIZE);
+    ++this->frames;
+    this->setStatus(this->status | (1 << NRF905_STATUS_DR));
+    return true;
+  }
+
+  // Frame addressed to this radio received; only a radio in RX mode hears it
+  bool receive(const uint8_t *const pPayload, const uint8_t length) {
+    if (this->mode() != esphome::nrf905::Receive) {
+      return false;
+    }
+    (void) memset(this->rxPayload, 0, NRF905_MAX_FRAMESIZE);
+    (void) memcpy(this->rxPayload, pPayload, length);
+    this->setStatus(this->status | (1 << NRF905_STATUS_DR) | (1 << NRF905_STATUS_AM));
+    return true;
+  }
+
+  HostPin ce{12};
+  HostPin pwr{13};
+  HostPin txen{14};
+  HostPin dr{35};
+  HostPin am{32};
+
+  uint8_t config[NRF905_REGISTER_COUNT]{};
+  uint8_t txAddress[4]{};
+  uint8_t txPayload[NRF905_MAX_FRAMESIZE]{};
+  uint8_t rxPayload[NRF905_MAX_FRAMESIZE]{};
+  uint8_t sent[NRF905_MAX_FRAMESIZE]{};  // Payload of the last frame sent
+  uint8_t status{0x00};
+  uint32_t frames{0};  // Frames sent
+
+ protected:
+  // Called on every mode pin write; DR of a sent frame stays until the radio leaves TX mode
+  void follow(void) {
+    const esphome::nrf905::Mode mode = this->mode();
+
+    if ((this->lastMode_ == esphome::nrf905::Transmit) && (mode != esphome::nrf905::Transmit)) {
+      this->setStatus(this->status & ~(1 << NRF905_STATUS_DR));
+    }
+    this->lastMode_ = mode;
+  }
+
+  // The DR and AM pins mirror the status bits
+  void setStatus(const uint8_t status) {
+    this->status = status;
+    this->dr.digital_write((status & (1 << NRF905_STATUS_DR)) != 0);
+    this->am.digital_write((status & (1 << NRF905_STATUS_AM)) != 0);
+  }
+
+  void transfer(uint8_t *const data, const size_t length) {
+    const uint8_t command = data[0];
+    const size_t size = length - 1;
+
+    data[0] = this->status;
+    switch (command) {
+      case NRF905_COMMAND_W_CONFIG:
+        (void) memcpy(this->config, &data[1], size);
+        break;
+
+      case NRF905_COMMAND_R_CONFIG:
+        (void) memcpy(&data[1], this->config, size);
+        break;
+
+      case NRF905_COMMAND_W_TX_PAYLOAD:
+        (void) memcpy(this->txPayload, &data[1], size);
+        break;
+
+      case NRF905_COMMAND_R_TX_PAYLOAD:
+        (void) memcpy(&data[1], this->txPayload, size);
+        break;
+
+      case NRF905_COMMAND_W_TX_ADDRESS:
+        (void) memcpy(this->txAddress, &data[1], size);
+        break;
+
+      case NRF905_COMMAND_R_TX_ADDRESS:
+        (void) memcpy(&data[1], this->txAddress, size);
+        break;
+
+      case NRF905_COMMAND_R_RX_PAYLOAD:
+        (void) memcpy(&data[1], this->rxPayload, size);
+        this->setStatus(this->status & ~((1 << NRF905_STATUS_DR) | (1 << NRF905_STATUS_AM)));
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  esphome::nrf905::Mode lastMode_{esphome::nrf905::PowerDown};
+};
+
+#endif /* __TESTS_HOST_FAKE_NRF905_H__ */
@@ -0,0 +1,20 @@
+#ifndef __TESTS_HOST_STUBS_BINARY_SENSOR_H__
+#define __TESTS_HOST_STUBS_BINARY_SENSOR_H__
+
+#include "esphome/core/component.h"
+
+/* Host stand-in for the ESPHome binary sensor; it keeps the last published state. */
+namespace esphome {
+namespace binary_sensor {
+
+class BinarySensor : public Nameable {
+ public:
+  void publish_state(bool state) { this->state = state; }
+
+  bool state{false};
+};
+
+}  // namespace binary_sensor
+}  // namespace esphome
+
+#endif /* __TESTS_HOST_STUBS_BINARY_SENSOR_H__ */
@@ -0,0 +1,78 @@
+#ifndef __TESTS_HOST_STUBS_FAN_STATE_H__
+#define __TESTS_HOST_STUBS_FAN_STATE_H__
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
+
+/* Host stand-in for the ESPHome fan: state and speed, and a call that carries optional new values. */
+namespace esphome {
+
+template<typename T> class optional {
+ public:
+  optional() {}
+  optional(const T &value) : value_(value), has_value_(true) {}
+
+  bool has_value() const { return this->has_value_; }
+  T value() const { return this->value_; }
+  T operator*() const { return this->value_; }
+
+ protected:
+  T value_{};
+  bool has_value_{false};
+};
+
+namespace fan {
+
+class FanTraits {
+ public:
+  FanTraits() {}
+  FanTraits(bool oscillation, bool speed, bool direction, int speed_count) : speed_count_(speed_count) {
+    (void) oscillation;
+    (void) speed;
+    (void) direction;
+  }
+
+  int supported_speed_count() const { return this->speed_count_; }
+
+ protected:
+  int speed_count_{0};
+};
+
+class FanCall {
+ public:
+  FanCall &set_state(bool state) {
+    this->state_ = state;
+    return *this;
+  }
+  FanCall &set_speed(int speed) {
+    this->speed_ = speed;
+    return *this;
+  }
+  optional<bool> get_state() const { return this->state_; }
+  optional<int> get_speed() const { return this->speed_; }
+
+ protected:
+  optional<bool> state_;
+  optional<int> speed_;
+};
+
+class Fan : public Nameable {
+ public:
+  virtual ~Fan() {}
+
+  void publish_state() { ++this->published; }
+  virtual FanTraits get_traits() = 0;
+
+  bool state{false};
+  int speed{0};
+  uint32_t published{0};
+
+ protected:
+  virtual void control(const FanCall &call) = 0;
+};
+
+}  // namespace fan
+}  // namespace esphome
+
+#endif /* __TESTS_HOST_STUBS_FAN_STATE_H__ */
@@ -0,0 +1,2 @@
+// Host builds include the component sources directly
+#include "nrf905/nRF905.h"
@@ -0,0 +1,31 @@
+#ifndef __TESTS_HOST_STUBS_SENSOR_H__
+#define __TESTS_HOST_STUBS_SENSOR_H__
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+
+/* Host stand-in for the ESPHome sensor; it keeps the last published state and tells the state callbacks. */
+namespace esphome {
+namespace sensor {
+
+class Sensor : public Nameable {
+ public:
+  void publish_state(float state) {
+    this->state = state;
+    ++this->published;
+    this->callbacks_.call(state);
+  }
+  void add_on_state_callback(std::function<void(float)> &&callback) { this->callbacks_.add(std::move(callback)); }
+  bool has_state() const { return this->published > 0; }
+
+  float state{0.0f};
+  uint32_t published{0};
+
+ protected:
+  CallbackManager<void(float)> callbacks_;
+};
+
+}  // namespace sensor
+}  // namespace esphome
+
+#endif /* __TESTS_HOST_STUBS_SENSOR_H__ */
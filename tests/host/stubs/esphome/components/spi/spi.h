@@ -0,0 +1,40 @@
+#ifndef __TESTS_HOST_STUBS_SPI_H__
+#define __TESTS_HOST_STUBS_SPI_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include "esphome/core/hal.h"
+
+/* Host stand-in for the ESPHome SPI device. Each transfer_array() goes to hostSpi, where a test puts the chip it
+ * simulates; enable() and disable() frame the transfer like the CS pin. */
+inline std::function<void(uint8_t *data, size_t length)> hostSpi;
+
+namespace esphome {
+namespace spi {
+
+enum SPIBitOrder { BIT_ORDER_LSB_FIRST, BIT_ORDER_MSB_FIRST };
+enum SPIClockPolarity { CLOCK_POLARITY_LOW, CLOCK_POLARITY_HIGH };
+enum SPIClockPhase { CLOCK_PHASE_LEADING, CLOCK_PHASE_TRAILING };
+enum SPIDataRate : uint32_t { DATA_RATE_1MHZ = 1000000, DATA_RATE_8MHZ = 8000000 };
+
+template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE, SPIDataRate DATA_RATE>
+class SPIDevice {
+ public:
+  void spi_setup() {}
+  void enable() {}
+  void disable() {}
+  void transfer_array(uint8_t *data, size_t length) {
+    if (hostSpi) {
+      hostSpi(data, length);
+    }
+  }
+
+ protected:
+  GPIOPin *cs_{nullptr};
+};
+
+}  // namespace spi
+}  // namespace esphome
+
+#endif /* __TESTS_HOST_STUBS_SPI_H__ */
@@ -0,0 +1,6 @@
+#ifndef __TESTS_HOST_STUBS_APPLICATION_H__
+#define __TESTS_HOST_STUBS_APPLICATION_H__
+
+#include "esphome/core/preferences.h"
+
+#endif /* __TESTS_HOST_STUBS_APPLICATION_H__ */
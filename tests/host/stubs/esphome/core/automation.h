@@ -0,0 +1,19 @@
+#ifndef __TESTS_HOST_STUBS_AUTOMATION_H__
+#define __TESTS_HOST_STUBS_AUTOMATION_H__
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+
+/* Host stand-in for ESPHome automations; a trigger only counts its firings. */
+namespace esphome {
+
+template<typename... Ts> class Trigger {
+ public:
+  void trigger(Ts... /*args*/) { ++this->fired; }
+
+  uint32_t fired{0};
+};
+
+}  // namespace esphome
+
+#endif /* __TESTS_HOST_STUBS_AUTOMATION_H__ */
@@ -0,0 +1,50 @@
+#ifndef __TESTS_HOST_STUBS_COMPONENT_H__
+#define __TESTS_HOST_STUBS_COMPONENT_H__
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+
+/* Host stand-in for the ESPHome component base. There is no scheduler: intervals, timeouts and deferred calls are
+ * accepted and dropped, and a test calls the entry points it exercises itself. */
+namespace esphome {
+
+namespace setup_priority {
+const float HARDWARE = 800.0f;
+const float DATA = 600.0f;
+const float AFTER_CONNECTION = 100.0f;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() {}
+
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return 0.0f; }
+
+  void mark_failed() { this->failed_ = true; }
+  bool is_failed() const { return this->failed_; }
+
+ protected:
+  void set_interval(const std::string & /*name*/, uint32_t /*interval*/, std::function<void()> && /*f*/) {}
+  bool cancel_interval(const std::string & /*name*/) { return true; }
+  void set_timeout(const std::string & /*name*/, uint32_t /*timeout*/, std::function<void()> && /*f*/) {}
+  void set_timeout(uint32_t /*timeout*/, std::function<void()> && /*f*/) {}
+  bool cancel_timeout(const std::string & /*name*/) { return true; }
+  void defer(std::function<void()> && /*f*/) {}
+
+  bool failed_{false};
+};
+
+class Nameable {
+ public:
+  const std::string &get_name() const { return this->name_; }
+
+  std::string name_;
+};
+
+}  // namespace esphome
+
+#endif /* __TESTS_HOST_STUBS_COMPONENT_H__ */
@@ -0,0 +1,7 @@
+#ifndef __TESTS_HOST_STUBS_DEFINES_H__
+#define __TESTS_HOST_STUBS_DEFINES_H__
+
+/* Host stand-in for the defines generated from the YAML configuration. No optional ESPHome components: no USE_TIME,
+ * and no USE_ESP32, so the radio runs without the GPIO registers and the FreeRTOS task. */
+
+#endif /* __TESTS_HOST_STUBS_DEFINES_H__ */
@@ -0,0 +1,56 @@
+#ifndef __TESTS_HOST_STUBS_HAL_H__
+#define __TESTS_HOST_STUBS_HAL_H__
+
+#include <stdint.h>
+#include <string>
+
+#define IRAM_ATTR
+
+/* Host stand-in for the ESPHome HAL. Time stands still unless the test moves hostMicros, or a delay() does; the pin
+ * classes are the interfaces only, a test supplies its own pins. */
+inline uint32_t hostMicros = 0;
+
+namespace esphome {
+
+inline uint32_t micros() { return hostMicros; }
+inline uint32_t millis() { return hostMicros / 1000; }
+inline void delay(uint32_t ms) { hostMicros += ms * 1000; }
+inline void delayMicroseconds(uint32_t us) { hostMicros += us; }
+
+namespace gpio {
+enum InterruptType { INTERRUPT_RISING_EDGE = 1, INTERRUPT_FALLING_EDGE = 2, INTERRUPT_ANY_EDGE = 3 };
+}  // namespace gpio
+
+class ISRInternalGPIOPin {
+ public:
+  bool digital_read() { return false; }
+  void digital_write(bool /*value*/) {}
+};
+
+class GPIOPin {
+ public:
+  virtual ~GPIOPin() {}
+
+  virtual void setup() = 0;
+  virtual bool digital_read() = 0;
+  virtual void digital_write(bool value) = 0;
+  virtual std::string dump_summary() const { return ""; }
+};
+
+class InternalGPIOPin : public GPIOPin {
+ public:
+  virtual uint8_t get_pin() const = 0;
+  virtual bool is_inverted() const = 0;
+  virtual ISRInternalGPIOPin to_isr() const { return ISRInternalGPIOPin(); }
+  template<typename T> void attach_interrupt(void (*func)(T *), T *arg, gpio::InterruptType type) const {
+    this->attach_interrupt(reinterpret_cast<void (*)(void *)>(func), arg, type);
+  }
+  virtual void detach_interrupt() const {}
+
+ protected:
+  virtual void attach_interrupt(void (* /*func*/)(void *), void * /*arg*/, gpio::InterruptType /*type*/) const {}
+};
+
+}  // namespace esphome
+
+#endif /* __TESTS_HOST_STUBS_HAL_H__ */
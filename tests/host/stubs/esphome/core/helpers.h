@@ -0,0 +1,44 @@
+#ifndef __TESTS_HOST_STUBS_HELPERS_H__
+#define __TESTS_HOST_STUBS_HELPERS_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Host stand-in for the ESPHome helpers the components use. rand() is good enough, and seeded by the test when it
+ * needs a fixed sequence. */
+namespace esphome {
+
+static inline uint32_t random_uint32(void) { return ((uint32_t) rand() << 16) ^ (uint32_t) rand(); }
+
+static inline uint32_t fnv1_hash(const std::string &str) {
+  uint32_t hash = 2166136261UL;
+
+  for (const char c : str) {
+    hash *= 16777619UL;
+    hash ^= (uint8_t) c;
+  }
+  return hash;
+}
+
+template<typename T> class CallbackManager;
+
+template<typename... Ts> class CallbackManager<void(Ts...)> {
+ public:
+  void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+  void call(Ts... args) {
+    for (auto &callback : this->callbacks_) {
+      callback(args...);
+    }
+  }
+
+ protected:
+  std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+}  // namespace esphome
+
+#endif /* __TESTS_HOST_STUBS_HELPERS_H__ */
@@ -0,0 +1,57 @@
+#ifndef __TESTS_HOST_STUBS_LOG_H__
+#define __TESTS_HOST_STUBS_LOG_H__
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Host stand-in for the ESPHome logger. The log macros take their arguments and drop them; the logger functions
+ * count their calls and keep the last line, so a test can check what reached the logger. */
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+#define ESPHOME_LOG_LEVEL_VERY_VERBOSE 7
+#ifndef ESPHOME_LOG_LEVEL
+#define ESPHOME_LOG_LEVEL ESPHOME_LOG_LEVEL_NONE
+#endif
+
+inline uint32_t hostLogLines = 0;
+inline char hostLogLast[256];
+
+inline void esp_log_vprintf_(int level, const char *tag, int line, const char *format, va_list args) {
+  (void) level;
+  (void) tag;
+  (void) line;
+  ++hostLogLines;
+  (void) vsnprintf(hostLogLast, sizeof(hostLogLast), format, args);
+}
+
+inline void esp_log_printf_(int level, const char *tag, int line, const char *format, ...) {
+  va_list args;
+
+  va_start(args, format);
+  esp_log_vprintf_(level, tag, line, format, args);
+  va_end(args);
+}
+
+static inline void hostLog(const char *const tag, const char *const format, ...) {
+  (void) tag;
+  (void) format;
+}
+
+#define ESP_LOGE(tag, ...) hostLog(tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) hostLog(tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) hostLog(tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) hostLog(tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) hostLog(tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) hostLog(tag, __VA_ARGS__)
+#define LOG_PIN(prefix, pin) hostLog(prefix, "%p", (const void *) (pin))
+#define LOG_SENSOR(prefix, type, obj) hostLog(prefix, type, (const void *) (obj))
+#define LOG_BINARY_SENSOR(prefix, type, obj) hostLog(prefix, type, (const void *) (obj))
+
+#endif /* __TESTS_HOST_STUBS_LOG_H__ */
@@ -0,0 +1,53 @@
+#ifndef __TESTS_HOST_STUBS_PREFERENCES_H__
+#define __TESTS_HOST_STUBS_PREFERENCES_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <map>
+#include <vector>
+
+/* Host stand-in for the ESPHome preferences: saved objects live in memory for as long as the test runs, so a test
+ * can store a state before setup() loads it. */
+namespace esphome {
+
+inline std::map<uint32_t, std::vector<uint8_t>> hostPreferences;
+
+class ESPPreferenceObject {
+ public:
+  ESPPreferenceObject() {}
+  explicit ESPPreferenceObject(const uint32_t type) : type_(type) {}
+
+  template<typename T> bool save(const T *src) {
+    const uint8_t *const pBytes = (const uint8_t *) src;
+
+    hostPreferences[this->type_] = std::vector<uint8_t>(pBytes, pBytes + sizeof(T));
+    return true;
+  }
+
+  template<typename T> bool load(T *dest) {
+    const auto entry = hostPreferences.find(this->type_);
+
+    if ((entry == hostPreferences.end()) || (entry->second.size() != sizeof(T))) {
+      return false;
+    }
+    (void) memcpy((void *) dest, entry->second.data(), sizeof(T));
+    return true;
+  }
+
+ protected:
+  uint32_t type_{0};
+};
+
+class ESPPreferences {
+ public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool /*in_flash*/) {
+    return ESPPreferenceObject(type);
+  }
+};
+
+inline ESPPreferences hostPreferenceStore;
+inline ESPPreferences *global_preferences = &hostPreferenceStore;
+
+}  // namespace esphome
+
+#endif /* __TESTS_HOST_STUBS_PREFERENCES_H__ */
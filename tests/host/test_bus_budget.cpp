@@ -0,0 +1,253 @@
+/*
+ * Host test of the bus budget: a query and a set speed exchange with the fan, run through ZehnderRF and the nRF905
+ * driver against a simulated radio, stay within BUS_BUDGET_* per frame sent. Frames on the air that no transaction
+ * waits for do not count against it.
+ *
+ *   g++ -std=c++17 -Wall -Wextra -Wno-implicit-fallthrough -I tests/host/stubs -I tests/host -I components \
+ *       -o test_bus_budget tests/host/test_bus_budget.cpp components/zehnder/zehnder.cpp \
+ *       components/zehnder/demand.cpp components/zehnder/publish.cpp components/zehnder/repeater.cpp \
+ *       components/zehnder/schedule.cpp components/zehnder/tx_power.cpp components/nrf905/nRF905.cpp \
+ *       components/nrf905/memory.cpp components/nrf905/occupancy.cpp components/nrf905/radio_log.cpp
+ */
+
+#include <string.h>
+#include <functional>
+
+#include "nrf905/clock.h"
+#include "nrf905/nRF905.h"
+#include "zehnder/zehnder.h"
+#include "fake_nrf905.h"
+#include "check.h"
+
+using esphome::nrf905::nRF905;
+using esphome::nrf905::VirtualClock;
+using esphome::zehnder::ZehnderRF;
+
+#define NETWORK_ID 0x12345678
+#define MAIN_UNIT_ID 0x11
+#define BRIDGE_ID 0x22
+#define REMOTE_ID 0x33  // Another remote on the same network
+
+#define RX_DEDUP_WINDOW 250  // ms
+
+// Exposes the bus accounting of the bridge
+class BudgetBridge : public ZehnderRF {
+ public:
+  using ZehnderRF::BusCost;
+  using ZehnderRF::Config;
+  using ZehnderRF::busCost;
+  using ZehnderRF::busOverruns_;
+  using ZehnderRF::busStart_;
+};
+
+// Bridge paired with a fan, on a simulated radio with DR and AM wired
+class Bench {
+ public:
+  Bench() {
+    BudgetBridge::Config config = {NETWORK_ID, esphome::zehnder::FAN_TYPE_REMOTE_CONTROL, BRIDGE_ID,
+                                   esphome::zehnder::FAN_TYPE_MAIN_UNIT, MAIN_UNIT_ID};
+
+    (void) esphome::global_preferences->make_preference<BudgetBridge::Config>(esphome::fnv1_hash("zehnderrf"), true)
+        .save(&config);
+
+    this->chip.attach(&this->radio, true);
+    this->radio.set_clock(&this->clock);
+    this->radio.set_rx_dedup_window(RX_DEDUP_WINDOW);
+    this->bridge.set_rf(&this->radio);
+    this->bridge.set_clock(&this->clock);
+    this->bridge.set_update_interval(600000);
+
+    this->radio.setup();
+    this->bridge.setup();
+  }
+
+  void step(void) {
+    this->clock.advance(1);
+    this->radio.loop();
+    this->bridge.loop();
+  }
+
+  bool runUntil(const std::function<bool(void)> &done, const uint32_t limit) {
+    for (uint32_t i = 0; i < limit; ++i) {
+      if (done() == true) {
+        return true;
+      }
+      this->step();
+    }
+    return done();
+  }
+
+  // Wait for the bridge to key up, then complete its frame on air
+  bool send(void) {
+    if (this->runUntil([this](void) { return this->chip.mode() == esphome::nrf905::Transmit; }, 100) == false) {
+      return false;
+    }
+    if (this->chip.txDone() == false) {
+      return false;
+    }
+    this->step();
+    return true;
+  }
+
+  bool fanSettings(const uint8_t speed) {
+    const uint8_t frame[FAN_FRAMESIZE] = {esphome::zehnder::FAN_TYPE_REMOTE_CONTROL,
+                                          BRIDGE_ID,
+                                          esphome::zehnder::FAN_TYPE_MAIN_UNIT,
+                                          MAIN_UNIT_ID,
+                                          FAN_TTL,
+                                          esphome::zehnder::FAN_TYPE_FAN_SETTINGS,
+                                          0x03,
+                                          speed,
+                                          0x32,
+                                          0x00};
+
+    return this->receive(frame);
+  }
+
+  // Another remote setting the fan; nothing the bridge waits for
+  bool otherRemote(void) {
+    const uint8_t frame[FAN_FRAMESIZE] = {esphome::zehnder::FAN_TYPE_MAIN_UNIT,
+                                          MAIN_UNIT_ID,
+                                          esphome::zehnder::FAN_TYPE_REMOTE_CONTROL,
+                                          REMOTE_ID,
+                                          FAN_TTL,
+                                          esphome::zehnder::FAN_FRAME_SETSPEED,
+                                          0x01,
+                                          esphome::zehnder::FAN_SPEED_LOW};
+
+    return this->receive(frame);
+  }
+
+  bool receive(const uint8_t *const pFrame) {
+    if (this->chip.receive(pFrame, FAN_FRAMESIZE) == false) {
+      return false;
+    }
+    this->step();
+    return true;
+  }
+
+  // Paired bridge starts with a query of the fan and an inventory sweep
+  int start(void) {
+    BudgetBridge::BusCost begin;
+
+    CHECK(this->runUntil([this](void) { return this->chip.mode() == esphome::nrf905::Transmit; }, 20000));
+    CHECK(this->chip.txPayload[5] == esphome::zehnder::FAN_TYPE_QUERY_DEVICE);
+    begin = this->bridge.busStart_;
+    CHECK(this->send());
+    CHECK(this->fanSettings(esphome::zehnder::FAN_SPEED_MEDIUM));
+    this->queryCost = this->since(begin);
+
+    // Inventory broadcast; no one answers within the window
+    CHECK(this->send());
+    CHECK(this->chip.sent[5] == esphome::zehnder::FAN_TYPE_QUERY_NETWORK);
+    for (uint32_t i = 0; i <= INVENTORY_WINDOW; ++i) {
+      this->step();
+    }
+
+    return 0;
+  }
+
+  // Past the dedup window, else the same settings reply of the next exchange is dropped as a repeat
+  void settle(void) {
+    for (uint32_t i = 0; i <= RX_DEDUP_WINDOW; ++i) {
+      this->step();
+    }
+  }
+
+  // Bus cost from begin, a busCost() reading or the snapshot a transaction took at its start, up to now
+  BudgetBridge::BusCost since(const BudgetBridge::BusCost &begin) {
+    BudgetBridge::BusCost cost;
+
+    this->bridge.busCost(&cost);
+    cost.transfers -= begin.transfers;
+    cost.bytes -= begin.bytes;
+    cost.pinWrites -= begin.pinWrites;
+    return cost;
+  }
+
+  FakeNrf905 chip;
+  VirtualClock clock;
+  nRF905 radio;
+  BudgetBridge bridge;
+  BudgetBridge::BusCost queryCost{};
+};
+
+static bool withinBudget(const BudgetBridge::BusCost &cost, const uint32_t frames) {
+  return (cost.transfers > 0) && (cost.transfers <= BUS_BUDGET_TRANSFERS * frames) &&
+         (cost.bytes <= BUS_BUDGET_BYTES * frames) && (cost.pinWrites <= BUS_BUDGET_PIN_WRITES * frames);
+}
+
+// One frame out, the settings back
+static int testQuery(void) {
+  Bench bench;
+
+  CHECK(bench.start() == 0);
+  CHECK(withinBudget(bench.queryCost, 1));
+  CHECK(bench.bridge.busOverruns_ == 0);
+
+  return 0;
+}
+
+// Set speed, the settings back, and the acknowledge: two frames out
+static int setSpeed(Bench *const pBench, const bool traffic, BudgetBridge::BusCost *const pCost) {
+  BudgetBridge::BusCost begin;
+
+  pBench->settle();
+  pBench->bridge.busCost(&begin);
+  (void) pBench->bridge.setSpeed(esphome::zehnder::FAN_SPEED_HIGH);
+  CHECK(pBench->send());
+  CHECK(pBench->chip.sent[5] == esphome::zehnder::FAN_FRAME_SETSPEED);
+
+  if (traffic == true) {
+    // Heard while waiting for the reply, once and once repeated
+    CHECK(pBench->otherRemote());
+    CHECK(pBench->otherRemote());
+    CHECK(pBench->radio.getRxDuplicates() == 1);
+  }
+
+  CHECK(pBench->fanSettings(esphome::zehnder::FAN_SPEED_HIGH));
+  CHECK(pBench->send());
+  CHECK(pBench->chip.sent[5] == esphome::zehnder::FAN_FRAME_SETSPEED_REPLY);
+
+  // The acknowledge ends the transaction as it goes out; its return to receive counts too
+  pBench->settle();
+  *pCost = pBench->since(begin);
+
+  return 0;
+}
+
+static int testSetSpeed(void) {
+  Bench bench;
+  BudgetBridge::BusCost cost;
+
+  CHECK(bench.start() == 0);
+  CHECK(setSpeed(&bench, false, &cost) == 0);
+  CHECK(withinBudget(cost, 2));
+  CHECK(bench.bridge.busOverruns_ == 0);
+
+  return 0;
+}
+
+static int testTrafficNotCounted(void) {
+  Bench bench;
+  BudgetBridge::BusCost quiet;
+  BudgetBridge::BusCost busy;
+
+  CHECK(bench.start() == 0);
+  CHECK(setSpeed(&bench, false, &quiet) == 0);
+  CHECK(setSpeed(&bench, true, &busy) == 0);
+  CHECK(busy.transfers == quiet.transfers);
+  CHECK(busy.bytes == quiet.bytes);
+  CHECK(busy.pinWrites == quiet.pinWrites);
+  CHECK(bench.bridge.busOverruns_ == 0);
+
+  return 0;
+}
+
+int main(void) {
+  RUN(testQuery);
+  RUN(testSetSpeed);
+  RUN(testTrafficNotCounted);
+
+  return 0;
+}
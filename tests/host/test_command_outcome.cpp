@@ -0,0 +1,166 @@
+/*
+ * Host test of command outcomes: every command handed out by setSpeed() or setVoltage() reports exactly one outcome,
+ * a timeout when the real one got lost, whether or not it is the pending command of control().
+ *
+ *   g++ -std=c++17 -Wall -Wextra -Wno-implicit-fallthrough -I tests/host/stubs -I tests/host -I components \
+ *       -o test_command_outcome tests/host/test_command_outcome.cpp components/zehnder/zehnder.cpp \
+ *       components/zehnder/demand.cpp components/zehnder/publish.cpp components/zehnder/repeater.cpp \
+ *       components/zehnder/schedule.cpp components/zehnder/tx_power.cpp components/nrf905/nRF905.cpp \
+ *       components/nrf905/memory.cpp components/nrf905/occupancy.cpp components/nrf905/radio_log.cpp
+ */
+
+#include <vector>
+
+#include "nrf905/clock.h"
+#include "nrf905/nRF905.h"
+#include "zehnder/zehnder.h"
+#include "fake_nrf905.h"
+#include "check.h"
+
+using esphome::nrf905::nRF905;
+using esphome::nrf905::VirtualClock;
+using esphome::zehnder::CommandOutcome;
+using esphome::zehnder::ZehnderRF;
+
+// Exposes the outcome bookkeeping of the bridge
+class OutcomeBridge : public ZehnderRF {
+ public:
+  using ZehnderRF::commandNotify;
+  using ZehnderRF::pendingCheck;
+  using ZehnderRF::RadioEvent;
+  using ZehnderRF::radioEvents_;
+
+  // Fill the event queue, so the outcomes of the next commands are dropped
+  void blockEvents(void) {
+    RadioEvent event{};
+
+    event.type = RadioEventTxPower;
+    while (this->radioEvents_.push(event) == true) {
+    }
+  }
+};
+
+// Unpaired bridge; it rejects every setting right away
+class Bench {
+ public:
+  Bench() {
+    this->chip.attach(&this->radio);
+    this->radio.set_clock(&this->clock);
+    this->bridge.set_rf(&this->radio);
+    this->bridge.set_clock(&this->clock);
+    this->bridge.add_on_command_callback([this](const CommandOutcome &outcome) { this->outcomes.push_back(outcome); });
+
+    this->radio.setup();
+    this->bridge.setup();
+  }
+
+  // Let the fallback look for lost outcomes after this long
+  void advance(const uint32_t time) {
+    this->clock.advance(time);
+    this->bridge.pendingCheck();
+  }
+
+  FakeNrf905 chip;
+  VirtualClock clock;
+  nRF905 radio;
+  OutcomeBridge bridge;
+  std::vector<CommandOutcome> outcomes;
+};
+
+static uint32_t reported(const std::vector<CommandOutcome> &outcomes, const uint16_t id) {
+  uint32_t count = 0;
+
+  for (const CommandOutcome &outcome : outcomes) {
+    if (outcome.id == id) {
+      ++count;
+    }
+  }
+
+  return count;
+}
+
+static int testOutcomeOnce(void) {
+  Bench bench;
+  uint16_t id;
+
+  id = bench.bridge.setSpeed(esphome::zehnder::FAN_SPEED_HIGH, 0);
+  bench.bridge.loop();
+  CHECK(bench.outcomes.size() == 1);
+  CHECK(bench.outcomes[0].id == id);
+  CHECK(bench.outcomes[0].result == esphome::zehnder::CommandRejected);
+
+  // Reported, so no timeout later on
+  bench.advance(COMMAND_OUTCOME_TIMEOUT + 1);
+  CHECK(bench.outcomes.size() == 1);
+
+  return 0;
+}
+
+// Schedule, demand and service commands are never pending; they time out all the same
+static int testLostOutcomes(void) {
+  Bench bench;
+  uint16_t speedId;
+  uint16_t voltageId;
+
+  bench.bridge.blockEvents();
+  speedId = bench.bridge.setSpeed(esphome::zehnder::FAN_SPEED_HIGH, 0);
+  bench.advance(1);
+  voltageId = bench.bridge.setVoltage(50);
+  bench.bridge.loop();
+  CHECK(bench.outcomes.empty() == true);
+
+  bench.advance(COMMAND_OUTCOME_TIMEOUT - 1);
+  CHECK(bench.outcomes.empty() == true);
+  bench.advance(1);
+  CHECK(bench.outcomes.size() == 1);
+  CHECK(bench.outcomes[0].id == speedId);
+  CHECK(bench.outcomes[0].result == esphome::zehnder::CommandTimeout);
+
+  bench.advance(1);
+  CHECK(bench.outcomes.size() == 2);
+  CHECK(bench.outcomes[1].id == voltageId);
+  CHECK(bench.outcomes[1].result == esphome::zehnder::CommandTimeout);
+
+  // Once each, and a late outcome does not report the command again
+  bench.advance(COMMAND_OUTCOME_TIMEOUT);
+  bench.bridge.commandNotify({speedId, esphome::zehnder::CommandRejected, 0, 0});
+  CHECK(bench.outcomes.size() == 2);
+
+  return 0;
+}
+
+// More open commands than tracked: the oldest is reported right away, none twice
+static int testTrackFull(void) {
+  Bench bench;
+  uint16_t first;
+  uint8_t i;
+
+  bench.bridge.blockEvents();
+  first = bench.bridge.setSpeed(esphome::zehnder::FAN_SPEED_LOW, 0);
+  for (i = 1; i < COMMAND_TRACK_SIZE; ++i) {
+    bench.clock.advance(1);
+    (void) bench.bridge.setSpeed(esphome::zehnder::FAN_SPEED_LOW, 0);
+  }
+  CHECK(bench.outcomes.empty() == true);
+
+  (void) bench.bridge.setSpeed(esphome::zehnder::FAN_SPEED_LOW, 0);
+  CHECK(bench.outcomes.size() == 1);
+  CHECK(bench.outcomes[0].id == first);
+
+  bench.bridge.loop();
+  bench.advance(COMMAND_OUTCOME_TIMEOUT + 1);
+  CHECK(bench.outcomes.size() == COMMAND_TRACK_SIZE + 1);
+  for (i = 0; i <= COMMAND_TRACK_SIZE; ++i) {
+    CHECK(reported(bench.outcomes, first + i) == 1);
+  }
+
+  return 0;
+}
+
+int main(void) {
+  RUN(testOutcomeOnce);
+  RUN(testLostOutcomes);
+  RUN(testTrackFull);
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Host test of the nRF905 main loop with the DR and AM pins wired: loop() leaves the radio alone until a pin edge, and
+ * then handles the received or sent frame.
+ *
+ *   g++ -std=c++17 -Wall -Wextra -I tests/host/stubs -I tests/host -I components -o test_nrf905_idle \
+ *       tests/host/test_nrf905_idle.cpp components/nrf905/nRF905.cpp components/nrf905/memory.cpp \
+ *       components/nrf905/occupancy.cpp components/nrf905/radio_log.cpp
+ */
+
+#include "nrf905/clock.h"
+#include "nrf905/nRF905.h"
+#include "fake_nrf905.h"
+#include "check.h"
+
+using esphome::nrf905::BusCounters;
+using esphome::nrf905::nRF905;
+using esphome::nrf905::VirtualClock;
+
+static uint32_t spiTransfers(nRF905 *const pRadio) {
+  BusCounters counters;
+  uint32_t transfers = 0;
+
+  pRadio->getBusCounters(&counters);
+  for (uint8_t op = 0; op < esphome::nrf905::SpiOpNrOf; ++op) {
+    transfers += counters.transfers[op];
+  }
+
+  return transfers;
+}
+
+static int testIdleReceive(void) {
+  FakeNrf905 chip;
+  VirtualClock clock;
+  nRF905 radio;
+  uint32_t received = 0;
+  uint32_t transfers;
+  const uint8_t frame[16] = {0x04, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+
+  chip.attach(&radio, true);
+  radio.set_clock(&clock);
+  radio.setup();
+  radio.setOnRxComplete([&received](const uint8_t *const pBuffer, const uint8_t size) {
+    (void) pBuffer;
+    (void) size;
+    ++received;
+  });
+  radio.setMode(esphome::nrf905::Receive);
+
+  // Listening, nothing on air: no SPI at all
+  transfers = spiTransfers(&radio);
+  for (uint32_t i = 0; i < 100; ++i) {
+    radio.loop();
+  }
+  CHECK(spiTransfers(&radio) == transfers);
+
+  CHECK(chip.receive(frame, sizeof(frame)) == true);
+  CHECK(chip.dr.interrupts == 1);
+  radio.loop();
+  CHECK(received == 1);
+  CHECK(chip.dr.level == false);
+
+  // Back to idle after the frame
+  transfers = spiTransfers(&radio);
+  for (uint32_t i = 0; i < 100; ++i) {
+    radio.loop();
+  }
+  CHECK(spiTransfers(&radio) == transfers);
+  CHECK(received == 1);
+
+  return 0;
+}
+
+static int testBackToBack(void) {
+  FakeNrf905 chip;
+  VirtualClock clock;
+  nRF905 radio;
+  uint32_t received = 0;
+  uint8_t frame[16] = {0x04, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+
+  chip.attach(&radio, true);
+  radio.set_clock(&clock);
+  radio.setup();
+  radio.setOnRxComplete([&received](const uint8_t *const pBuffer, const uint8_t size) {
+    (void) pBuffer;
+    (void) size;
+    ++received;
+  });
+  radio.setMode(esphome::nrf905::Receive);
+
+  // The second frame arrives before the loop runs again; no status without DR and AM is seen in between
+  CHECK(chip.receive(frame, sizeof(frame)) == true);
+  radio.loop();
+  frame[7] = 0x07;
+  CHECK(chip.receive(frame, sizeof(frame)) == true);
+  radio.loop();
+  CHECK(received == 2);
+
+  return 0;
+}
+
+static int testIdleTransmit(void) {
+  FakeNrf905 chip;
+  VirtualClock clock;
+  nRF905 radio;
+  uint32_t txReady = 0;
+  uint32_t transfers;
+
+  chip.attach(&radio, true);
+  radio.set_clock(&clock);
+  radio.setup();
+
+  // Second frame from the TX ready of the first, like the fan protocol does
+  radio.setOnTxReady([&txReady, &radio](void) {
+    ++txReady;
+    if (txReady == 1) {
+      radio.startTx(0, esphome::nrf905::Receive);
+    }
+  });
+
+  radio.startTx(0, esphome::nrf905::Receive);
+  transfers = spiTransfers(&radio);
+  radio.loop();
+  CHECK(spiTransfers(&radio) == transfers);
+
+  CHECK(chip.txDone() == true);
+  radio.loop();
+  CHECK(txReady == 1);
+  CHECK(chip.mode() == esphome::nrf905::Transmit);
+
+  // The second frame leaves TX mode in between, so its DR is an edge of its own
+  CHECK(chip.txDone() == true);
+  radio.loop();
+  CHECK(txReady == 2);
+  CHECK(chip.mode() == esphome::nrf905::Receive);
+
+  return 0;
+}
+
+int main(void) {
+  RUN(testIdleReceive);
+  RUN(testBackToBack);
+  RUN(testIdleTransmit);
+
+  return 0;
+}
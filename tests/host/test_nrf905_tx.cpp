@@ -0,0 +1,122 @@
+/*
+ * Host test of the nRF905 TX ready path: process() reports each sent frame once, including a frame that the TX ready
+ * callback starts right away, before any status without DR was seen.
+ *
+ *   g++ -std=c++17 -Wall -Wextra -I tests/host/stubs -I tests/host -I components -o test_nrf905_tx \
+ *       tests/host/test_nrf905_tx.cpp components/nrf905/nRF905.cpp components/nrf905/memory.cpp \
+ *       components/nrf905/occupancy.cpp components/nrf905/radio_log.cpp
+ */
+
+#include "nrf905/clock.h"
+#include "nrf905/nRF905.h"
+#include "fake_nrf905.h"
+#include "check.h"
+
+using esphome::nrf905::nRF905;
+using esphome::nrf905::VirtualClock;
+
+static int testSingleFrame(void) {
+  FakeNrf905 chip;
+  VirtualClock clock;
+  nRF905 radio;
+  uint32_t txReady = 0;
+
+  chip.attach(&radio);
+  radio.set_clock(&clock);
+  radio.setup();
+  radio.setOnTxReady([&txReady](void) { ++txReady; });
+
+  radio.startTx(0, esphome::nrf905::Receive);
+  CHECK(chip.mode() == esphome::nrf905::Transmit);
+  radio.process();
+  CHECK(txReady == 0);
+
+  CHECK(chip.txDone() == true);
+  radio.process();
+  CHECK(txReady == 1);
+  CHECK(chip.mode() == esphome::nrf905::Receive);
+
+  // Reported once
+  radio.process();
+  CHECK(txReady == 1);
+
+  return 0;
+}
+
+static int testFrameFromCallback(void) {
+  FakeNrf905 chip;
+  VirtualClock clock;
+  nRF905 radio;
+  uint32_t txReady = 0;
+
+  chip.attach(&radio);
+  radio.set_clock(&clock);
+  radio.setup();
+
+  // Pipelined like the fan protocol: the next frame goes out from the TX ready of the previous one
+  radio.setOnTxReady([&txReady, &radio](void) {
+    ++txReady;
+    if (txReady < 3) {
+      radio.startTx(0, esphome::nrf905::Receive);
+    }
+  });
+
+  radio.startTx(0, esphome::nrf905::Receive);
+  CHECK(chip.txDone() == true);
+  radio.process();
+  CHECK(txReady == 1);
+  CHECK(chip.mode() == esphome::nrf905::Transmit);
+
+  // The next status read already has DR of the second frame; it must be seen as that frame's TX ready
+  CHECK(chip.txDone() == true);
+  radio.process();
+  CHECK(txReady == 2);
+  CHECK(chip.mode() == esphome::nrf905::Transmit);
+
+  CHECK(chip.txDone() == true);
+  radio.process();
+  CHECK(txReady == 3);
+  CHECK(chip.mode() == esphome::nrf905::Receive);
+  CHECK(chip.frames == 3);
+
+  return 0;
+}
+
+static int testReceiveAfterTx(void) {
+  FakeNrf905 chip;
+  VirtualClock clock;
+  nRF905 radio;
+  uint32_t txReady = 0;
+  uint32_t received = 0;
+  const uint8_t frame[16] = {0x04, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+
+  chip.attach(&radio);
+  radio.set_clock(&clock);
+  radio.setup();
+  radio.setOnTxReady([&txReady](void) { ++txReady; });
+  radio.setOnRxComplete([&received](const uint8_t *const pBuffer, const uint8_t size) {
+    (void) pBuffer;
+    (void) size;
+    ++received;
+  });
+
+  radio.startTx(0, esphome::nrf905::Receive);
+  CHECK(chip.txDone() == true);
+  radio.process();
+  CHECK(txReady == 1);
+
+  CHECK(chip.receive(frame, sizeof(frame)) == true);
+  radio.process();
+  CHECK(received == 1);
+  CHECK(txReady == 1);
+
+  return 0;
+}
+
+int main(void) {
+  RUN(testSingleFrame);
+  RUN(testFrameFromCallback);
+  RUN(testReceiveAfterTx);
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Host test of RadioLog: lines logged on the radio thread wait in the queue until the main loop flushes them, lines
+ * logged anywhere else reach the logger right away.
+ *
+ *   g++ -std=c++17 -Wall -Wextra -pthread -I tests/host/stubs -I components -o test_radio_log \
+ *       tests/host/test_radio_log.cpp components/nrf905/radio_log.cpp
+ */
+
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "nrf905/radio_log.h"
+#include "nrf905/radio_thread.h"
+#include "check.h"
+
+using esphome::nrf905::RadioLog;
+using esphome::nrf905::RadioThread;
+
+static const char *const TAG = "test";
+
+// Run one step on a radio thread and wait for it
+static void onRadioThread(RadioThread::Step step) {
+  RadioThread thread;
+  std::atomic<bool> done{false};
+
+  (void) thread.start("test", [&step, &done](void) {
+    if (done.load() == false) {
+      step();
+      done.store(true);
+    }
+  }, 1);
+  while (done.load() == false) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  thread.stop();
+}
+
+static int testMainLoopDirect(void) {
+  RadioLog radioLog;
+  const uint32_t lines = hostLogLines;
+
+  CHECK(RadioThread::isCurrent() == false);
+  radioLog.log(ESPHOME_LOG_LEVEL_DEBUG, TAG, __LINE__, "direct %u", 1u);
+  CHECK(hostLogLines == lines + 1);
+  CHECK(strcmp(hostLogLast, "direct 1") == 0);
+  return 0;
+}
+
+static int testRadioThreadQueued(void) {
+  RadioLog radioLog;
+  const uint32_t lines = hostLogLines;
+
+  onRadioThread([&radioLog](void) {
+    radioLog.log(ESPHOME_LOG_LEVEL_DEBUG, TAG, __LINE__, "queued %u", 2u);
+    radioLog.log(ESPHOME_LOG_LEVEL_WARN, TAG, __LINE__, "queued %u", 3u);
+  });
+
+  // Nothing reached the logger from the radio thread
+  CHECK(hostLogLines == lines);
+
+  radioLog.flush();
+  CHECK(hostLogLines == lines + 2);
+  CHECK(strcmp(hostLogLast, "queued 3") == 0);
+  CHECK(radioLog.getDropped() == 0);
+  return 0;
+}
+
+static int testOverflowCounted(void) {
+  RadioLog radioLog;
+  const uint32_t lines = hostLogLines;
+
+  onRadioThread([&radioLog](void) {
+    uint32_t i;
+
+    for (i = 0; i < (RADIO_LOG_LINES + 3); ++i) {
+      radioLog.log(ESPHOME_LOG_LEVEL_DEBUG, TAG, __LINE__, "line %u", i);
+    }
+  });
+
+  radioLog.flush();
+  CHECK(hostLogLines == lines + RADIO_LOG_LINES);
+  CHECK(radioLog.getDropped() == 3);
+  return 0;
+}
+
+int main(void) {
+  RUN(testMainLoopDirect);
+  RUN(testRadioThreadQueued);
+  RUN(testOverflowCounted);
+  return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * Host test of the std::thread backend of RadioThread, together with the SpscQueue it exchanges data through.
+ *
+ *   g++ -std=c++17 -Wall -Wextra -pthread -I components -o test_radio_thread tests/host/test_radio_thread.cpp
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "nrf905/radio_thread.h"
+#include "nrf905/spsc_queue.h"
+#include "check.h"
+
+using esphome::nrf905::RadioThread;
+using esphome::nrf905::SpscQueue;
+
+static int testPeriod(void) {
+  CHECK(RadioThread::roundPeriod(0) == 1);
+  CHECK(RadioThread::roundPeriod(1) == 1);
+  CHECK(RadioThread::roundPeriod(20) == 20);
+  return 0;
+}
+
+static int testStartStop(void) {
+  RadioThread thread;
+  std::atomic<uint32_t> steps{0};
+
+  CHECK(thread.isRunning() == false);
+  CHECK(thread.start("test", [&steps](void) { ++steps; }, 1) == true);
+  CHECK(thread.isRunning() == true);
+  CHECK(thread.getPeriod() == 1);
+  CHECK(thread.start("test", [&steps](void) { ++steps; }, 1) == false);  // Already running
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  thread.stop();
+  CHECK(thread.isRunning() == false);
+
+  // Steps stop with the thread; roughly one per period ran, allowing for a slow host
+  const uint32_t stopped = steps.load();
+  CHECK(stopped >= 10);
+  CHECK(stopped <= 110);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  CHECK(steps.load() == stopped);
+
+  // And it can be started again
+  CHECK(thread.start("test", [&steps](void) { ++steps; }, 1) == true);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  thread.stop();
+  CHECK(steps.load() > stopped);
+  return 0;
+}
+
+static int testQueue(void) {
+  static SpscQueue<uint32_t, 8> queue;
+  static std::atomic<uint32_t> next{0};
+  RadioThread thread;
+  uint32_t expected = 0;
+  uint32_t item;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+  // The thread produces a sequence, the main thread consumes it; nothing may be lost, duplicated or reordered
+  CHECK(thread.start(
+            "producer",
+            [](void) {
+              while ((next.load() < 1000) && (queue.push(next.load()) == true)) {
+                ++next;
+              }
+            },
+            1) == true);
+  while ((expected < 1000) && (std::chrono::steady_clock::now() < deadline)) {
+    if (queue.pop(&item) == true) {
+      CHECK(item == expected);
+      ++expected;
+    }
+  }
+  thread.stop();
+  CHECK(expected == 1000);
+  CHECK(queue.empty() == true);
+  return 0;
+}
+
+int main(void) {
+  RUN(testPeriod);
+  RUN(testStartStop);
+  RUN(testQueue);
+  return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Host test of the repeater's duplicate handling: copies of one transmission are forwarded once, a retry by the
+ * sender is forwarded again.
+ *
+ *   g++ -std=c++17 -Wall -Wextra -I tests/host/stubs -I components -o test_repeater tests/host/test_repeater.cpp \
+ *       components/zehnder/repeater.cpp
+ */
+
+#include <string.h>
+
+#include "zehnder/repeater.h"
+#include "check.h"
+
+using esphome::zehnder::Repeater;
+
+#define TTL 0xFA
+#define RETRY_INTERVAL 1000  // FAN_REPLY_TIMEOUT
+
+static void makeFrame(uint8_t *const pFrame, const uint8_t ttl) {
+  (void) memset(pFrame, 0, REPEATER_FRAMESIZE);
+  pFrame[0] = 0x01;  // rx_type
+  pFrame[1] = 0x42;  // rx_id
+  pFrame[2] = 0x03;  // tx_type
+  pFrame[3] = 0x17;  // tx_id
+  pFrame[REPEATER_TTL_OFFSET] = ttl;
+  pFrame[5] = 0x02;  // command
+}
+
+// Run the forwarding delay out and send; true when exactly one frame went out, with the TTL decremented
+static bool forward(Repeater *const pRepeater, const uint8_t ttl, const uint32_t now) {
+  const uint8_t *const pDue = pRepeater->due(now + 200);
+
+  if ((pDue == NULL) || (pDue[REPEATER_TTL_OFFSET] != (ttl - 1))) {
+    return false;
+  }
+  pRepeater->sent();
+  return pRepeater->getCount() == 0;
+}
+
+static int testCopiesDropped(void) {
+  Repeater repeater;
+  uint8_t frame[REPEATER_FRAMESIZE];
+  uint8_t copy[REPEATER_FRAMESIZE];
+
+  makeFrame(frame, TTL);
+  CHECK(repeater.offer(frame, 0) == true);
+  CHECK(forward(&repeater, TTL, 0) == true);
+
+  // The rest of the sender's burst, the copy another repeater forwarded, and a late one of those
+  CHECK(repeater.offer(frame, 5) == false);
+  CHECK(repeater.offer(frame, 10) == false);
+  makeFrame(copy, TTL - 1);
+  CHECK(repeater.offer(copy, 150) == false);
+  CHECK(repeater.offer(copy, REPEATER_SEEN_WINDOW - 1) == false);
+
+  CHECK(repeater.getStats()->forwarded == 1);
+  CHECK(repeater.getStats()->duplicates == 4);
+  return 0;
+}
+
+static int testRetryForwarded(void) {
+  Repeater repeater;
+  uint8_t frame[REPEATER_FRAMESIZE];
+  uint32_t now;
+
+  makeFrame(frame, TTL);
+
+  // The sender gets no reply and retries the same frame; every retry is heard with copies in between
+  for (now = 0; now < (5 * RETRY_INTERVAL); now += RETRY_INTERVAL) {
+    CHECK(repeater.offer(frame, now) == true);
+    CHECK(forward(&repeater, TTL, now) == true);
+    CHECK(repeater.offer(frame, now + 100) == false);
+    CHECK(repeater.offer(frame, now + 300) == false);
+  }
+
+  CHECK(repeater.getStats()->forwarded == 5);
+  return 0;
+}
+
+static int testTtlExpired(void) {
+  Repeater repeater;
+  uint8_t frame[REPEATER_FRAMESIZE];
+
+  makeFrame(frame, 1);
+  CHECK(repeater.offer(frame, 0) == false);
+  CHECK(repeater.getStats()->expired == 1);
+  CHECK(repeater.due(1000) == NULL);
+  return 0;
+}
+
+int main(void) {
+  RUN(testCopiesDropped);
+  RUN(testRetryForwarded);
+  RUN(testTtlExpired);
+  return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Host test of the adaptive TX power controller: stepping down on clean exchanges, up on marginal ones and misses,
+ * and the per-retry escalation within one exchange.
+ *
+ *   g++ -std=c++17 -Wall -Wextra -I tests/host/stubs -I components -o test_tx_power tests/host/test_tx_power.cpp \
+ *       components/zehnder/tx_power.cpp
+ */
+
+#include "zehnder/tx_power.h"
+#include "check.h"
+
+using esphome::zehnder::TxPowerController;
+
+#define PEER_TYPE 0x01
+#define PEER_ID 0x42
+
+// Run clean exchanges until the peer is at the lowest power allowed
+static void stepDown(TxPowerController *const pTxPower) {
+  uint8_t i;
+
+  for (i = 0; i < 100; ++i) {
+    (void) pTxPower->report(PEER_TYPE, PEER_ID, 0, true, i);
+  }
+}
+
+static int testStepDown(void) {
+  TxPowerController txPower;
+
+  txPower.set_min_power(-10);
+  txPower.set_clean_streak(3);
+
+  // Unknown peers get full power
+  CHECK(txPower.getPower(PEER_TYPE, PEER_ID) == TX_POWER_MAX);
+
+  CHECK(txPower.report(PEER_TYPE, PEER_ID, 0, true, 0) == false);
+  CHECK(txPower.report(PEER_TYPE, PEER_ID, 0, true, 1) == false);
+  CHECK(txPower.report(PEER_TYPE, PEER_ID, 0, true, 2) == true);
+  CHECK(txPower.getPower(PEER_TYPE, PEER_ID) == 6);
+
+  stepDown(&txPower);
+  CHECK(txPower.getPower(PEER_TYPE, PEER_ID) == -10);
+  return 0;
+}
+
+static int testRetryEscalates(void) {
+  TxPowerController txPower;
+
+  txPower.set_min_power(-10);
+  txPower.set_clean_streak(1);
+  stepDown(&txPower);
+
+  // Every retry goes out one level above the try before it, up to full power
+  CHECK(txPower.getPower(PEER_TYPE, PEER_ID, 0) == -10);
+  CHECK(txPower.getPower(PEER_TYPE, PEER_ID, 1) == -2);
+  CHECK(txPower.getPower(PEER_TYPE, PEER_ID, 2) == 6);
+  CHECK(txPower.getPower(PEER_TYPE, PEER_ID, 3) == TX_POWER_MAX);
+  CHECK(txPower.getPower(PEER_TYPE, PEER_ID, 10) == TX_POWER_MAX);
+
+  // Escalation is per exchange; the peer's own level is unchanged
+  CHECK(txPower.getPower(PEER_TYPE, PEER_ID) == -10);
+  return 0;
+}
+
+static int testMissAndMarginal(void) {
+  TxPowerController txPower;
+
+  txPower.set_min_power(-10);
+  txPower.set_clean_streak(1);
+  stepDown(&txPower);
+
+  CHECK(txPower.report(PEER_TYPE, PEER_ID, TX_POWER_STEP_UP, true, 200) == true);
+  CHECK(txPower.getPower(PEER_TYPE, PEER_ID) == -2);
+
+  CHECK(txPower.report(PEER_TYPE, PEER_ID, 3, false, 201) == true);
+  CHECK(txPower.getPower(PEER_TYPE, PEER_ID) == TX_POWER_MAX);
+  CHECK(txPower.getHistory(0) != NULL);
+  return 0;
+}
+
+int main(void) {
+  RUN(testStepDown);
+  RUN(testRetryEscalates);
+  RUN(testMissAndMarginal);
+  return 0;
+}
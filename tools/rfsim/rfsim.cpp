@@ -0,0 +1,745 @@
+/*
+ * Discrete-event simulator of the shared 868 MHz Zehnder/BUVA channel.
+ *
+ * Models frame airtime, carrier detect, collisions and lossy links for a site with several networks. Each network
+ * has a main unit that answers queries and speed commands, wall remotes, CO2 sensors and a number of bridges that
+ * follow the ZehnderRF transmit policy (wait for free airway, send, wait for reply, retry). Used to compare retry,
+ * backoff and polling policies before deploying them.
+ *
+ * Bridges keep their timestamps as 32 bit milliseconds from a VirtualClock, like the component does with millis().
+ * Their timing decisions are not modelled: they call the component's own code, compiled in from components/. Poll
+ * due, airway give-up and reply timeout are the checks of zehnder/deadline.h that ZehnderRF makes, received repeats
+ * go through the nRF905 RxDedup, and the fan state is published through the component's PublishLimiter.
+ *
+ * The --soak option runs 60 days starting one hour before the millis() wraparound. It reports the longest gap
+ * between successful polls and between fan state publishes, and polls or reply timeouts that came before their
+ * time, and fails when any is out of bounds. Wraparound and slow leak bugs in that code show up in seconds of wall
+ * time. The rest of ZehnderRF (transaction flows, the nRF905 driver) needs ESPHome and is not part of the run.
+ *
+ * Build and run on the host:
+ *   g++ -std=c++17 -O2 -Wall -Wextra -o rfsim tools/rfsim/rfsim.cpp components/zehnder/publish.cpp
+ *   ./rfsim --units 6 --bridges 2 --remotes 2 --co2 1 --hours 24 --policy backoff
+ *   ./rfsim --soak
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../components/nrf905/clock.h"
+#include "../../components/nrf905/dedup.h"
+#include "../../components/zehnder/deadline.h"
+#include "../../components/zehnder/publish.h"
+
+using esphome::zehnder::deadlinePassed;
+using esphome::zehnder::deadlineRemaining;
+
+// Protocol values, see components/zehnder/zehnder.h
+#define FAN_TX_FRAMES 4
+#define FAN_TX_RETRIES 10
+#define FAN_REPLY_TIMEOUT 1000
+
+#define FAN_TYPE_MAIN_UNIT 0x01
+#define FAN_TYPE_REMOTE_CONTROL 0x03
+#define FAN_TYPE_CO2_SENSOR 0x18
+
+#define FAN_FRAME_SETSPEED 0x02
+#define FAN_FRAME_SETSPEED_REPLY 0x05
+#define FAN_TYPE_FAN_SETTINGS 0x07
+#define FAN_TYPE_QUERY_DEVICE 0x10
+#define FAN_FRAME_CO2 0x25  // Placeholder for sensor reports
+
+// nRF905 timing: 50 kbit/s, 10 bit preamble, 4 byte address, 16 byte payload, 16 bit CRC
+#define AIRTIME_US (((10 + (4 + 16 + 2) * 8) * 1000000ULL) / 50000ULL)
+#define TX_SETTLE_US 650ULL  // Standby to TX
+#define FRAME_GAP_US 1000ULL
+#define LOOP_PERIOD_US 16000ULL  // ESPHome main loop
+#define AIRWAY_GIVE_UP_MS 5000
+#define POLL_CHECK_US 1000000ULL  // Longest sleep between polling checks
+#define MAIN_UNIT_RESPONSE_US 20000ULL
+#define RX_DEDUP_WINDOW 250        // nrf905 rx_dedup_window default (ms)
+#define PUBLISH_MIN_INTERVAL 1000  // zehnder publish: defaults (ms)
+#define PUBLISH_HEARTBEAT 600000
+
+typedef uint64_t SimTime;  // Microseconds
+
+typedef struct {
+  uint32_t network;
+  uint8_t rxType;
+  uint8_t rxId;
+  uint8_t txType;
+  uint8_t txId;
+  uint8_t command;
+} SimFrame;
+
+class Node;
+
+class Simulator {
+ public:
+  Simulator(const uint32_t seed, const uint32_t startMs) : clock_(startMs), startMs_(startMs), rng_(seed) {}
+
+  SimTime now(void) const { return this->now_; }
+  esphome::nrf905::Clock *clock(void) { return &this->clock_; }
+  std::mt19937 &rng(void) { return this->rng_; }
+
+  void at(const SimTime time, std::function<void(void)> fn) {
+    this->events_.push(Event{time, this->seq_++, std::move(fn)});
+  }
+  void after(const SimTime delay, std::function<void(void)> fn) { this->at(this->now_ + delay, std::move(fn)); }
+
+  void run(const SimTime end) {
+    while (!this->events_.empty() && (this->events_.top().time <= end)) {
+      Event event = this->events_.top();
+      this->events_.pop();
+      this->now_ = event.time;
+      this->clock_.set(this->startMs_ + (uint32_t) (this->now_ / 1000));
+      event.fn();
+    }
+    this->now_ = end;
+  }
+
+  double uniform(void) { return std::uniform_real_distribution<double>(0.0, 1.0)(this->rng_); }
+  SimTime exponential(const double mean) {
+    return (SimTime) std::exponential_distribution<double>(1.0 / mean)(this->rng_);
+  }
+
+ protected:
+  typedef struct {
+    SimTime time;
+    uint64_t seq;
+    std::function<void(void)> fn;
+  } Event;
+  struct Later {
+    bool operator()(const Event &a, const Event &b) const {
+      return (a.time != b.time) ? (a.time > b.time) : (a.seq > b.seq);
+    }
+  };
+
+  SimTime now_{0};
+  esphome::nrf905::VirtualClock clock_;
+  uint32_t startMs_;
+  uint64_t seq_{0};
+  std::mt19937 rng_;
+  std::priority_queue<Event, std::vector<Event>, Later> events_;
+};
+
+class Channel {
+ public:
+  Channel(Simulator *const pSim, const double per) : sim_(pSim), per_(per) {}
+
+  void attach(Node *const pNode) { this->nodes_.push_back(pNode); }
+  bool busy(void) const { return !this->active_.empty(); }
+
+  void transmit(Node *const pSender, const SimFrame &frame);
+
+  uint64_t frames{0};
+  uint64_t collided{0};
+  uint64_t lost{0};
+  SimTime busyTime{0};
+
+ protected:
+  typedef struct {
+    uint64_t id;
+    Node *pSender;
+    SimFrame frame;
+    bool collided;
+  } Transmission;
+
+  void finish(const uint64_t id);
+
+  Simulator *sim_;
+  double per_;
+  uint64_t nextId_{0};
+  SimTime busySince_{0};
+  std::vector<Node *> nodes_;
+  std::vector<Transmission> active_;
+};
+
+class Node {
+ public:
+  Node(Simulator *const pSim, Channel *const pChannel, const uint32_t network, const uint8_t type, const uint8_t id)
+      : sim_(pSim), channel_(pChannel), network_(network), type_(type), id_(id) {
+    pChannel->attach(this);
+  }
+  virtual ~Node() {}
+
+  uint32_t network(void) const { return this->network_; }
+  uint8_t type(void) const { return this->type_; }
+  uint8_t id(void) const { return this->id_; }
+  bool transmitting(void) const { return this->txBusyUntil_ > this->sim_->now(); }
+
+  virtual void start(void) {}
+  virtual void receive(const SimFrame &) {}
+
+  SimTime airtime{0};
+
+ protected:
+  // Send a frame 'repeats' times back to back, as the Zehnder devices do
+  void send(const SimFrame &frame, const unsigned repeats) {
+    SimTime offset = TX_SETTLE_US;
+
+    for (unsigned i = 0; i < repeats; ++i) {
+      this->sim_->after(offset, [this, frame]() { this->channel_->transmit(this, frame); });
+      offset += AIRTIME_US + FRAME_GAP_US;
+    }
+    this->txBusyUntil_ = std::max(this->txBusyUntil_, this->sim_->now() + offset);
+    this->airtime += repeats * AIRTIME_US;
+  }
+
+  SimFrame frameTo(const uint8_t rxType, const uint8_t rxId, const uint8_t command) const {
+    SimFrame frame = {this->network_, rxType, rxId, this->type_, this->id_, command};
+    return frame;
+  }
+
+  Simulator *sim_;
+  Channel *channel_;
+  uint32_t network_;
+  uint8_t type_;
+  uint8_t id_;
+  SimTime txBusyUntil_{0};
+};
+
+void Channel::transmit(Node *const pSender, const SimFrame &frame) {
+  const uint64_t id = this->nextId_++;
+  bool collision = false;
+
+  if (this->active_.empty()) {
+    this->busySince_ = this->sim_->now();
+  }
+  for (Transmission &tx : this->active_) {
+    tx.collided = true;
+    collision = true;
+  }
+  this->active_.push_back(Transmission{id, pSender, frame, collision});
+  ++this->frames;
+
+  this->sim_->after(AIRTIME_US, [this, id]() { this->finish(id); });
+}
+
+void Channel::finish(const uint64_t id) {
+  auto it = std::find_if(this->active_.begin(), this->active_.end(),
+                         [id](const Transmission &tx) { return tx.id == id; });
+  const Transmission tx = *it;
+
+  this->active_.erase(it);
+  if (this->active_.empty()) {
+    this->busyTime += this->sim_->now() - this->busySince_;
+  }
+
+  if (tx.collided) {
+    ++this->collided;
+    return;
+  }
+
+  for (Node *const pNode : this->nodes_) {
+    if ((pNode == tx.pSender) || (pNode->network() != tx.frame.network)) {
+      continue;  // Different address; the radio filters it
+    }
+    if (pNode->transmitting()) {
+      continue;  // Half duplex
+    }
+    if (this->sim_->uniform() < this->per_) {
+      ++this->lost;
+      continue;
+    }
+    pNode->receive(tx.frame);
+  }
+}
+
+class Stats {
+ public:
+  void add(const bool delivered, const SimTime latency, const unsigned attempts) {
+    ++this->requests;
+    this->attempts += attempts;
+    if (delivered) {
+      ++this->delivered;
+      this->latencies_.push_back(latency / 1000.0);
+    }
+  }
+
+  double percentile(const double p) {
+    if (this->latencies_.empty()) {
+      return 0.0;
+    }
+    std::sort(this->latencies_.begin(), this->latencies_.end());
+    return this->latencies_[(size_t) (p * (this->latencies_.size() - 1))];
+  }
+
+  void print(const char *const name) {
+    printf("  %-10s requests %7llu  delivered %6.2f%%  attempts/req %5.2f  latency ms p50 %7.1f p90 %7.1f p99 %7.1f "
+           "max %7.1f\n",
+           name, (unsigned long long) this->requests,
+           this->requests ? (100.0 * this->delivered / this->requests) : 0.0,
+           this->requests ? ((double) this->attempts / this->requests) : 0.0, this->percentile(0.5),
+           this->percentile(0.9), this->percentile(0.99), this->percentile(1.0));
+  }
+
+  uint64_t requests{0};
+  uint64_t delivered{0};
+  uint64_t attempts{0};
+
+ protected:
+  std::vector<double> latencies_;
+};
+
+typedef struct {
+  SimTime replyTimeout;
+  unsigned retries;
+  bool backoff;
+  bool carrierSense;
+  SimTime pollInterval;
+  double commandInterval;  // Mean time between speed commands (us)
+} BridgePolicy;
+
+class MainUnit : public Node {
+ public:
+  MainUnit(Simulator *const pSim, Channel *const pChannel, const uint32_t network, const uint8_t id)
+      : Node(pSim, pChannel, network, FAN_TYPE_MAIN_UNIT, id) {}
+
+  void receive(const SimFrame &frame) override {
+    if ((frame.rxType != this->type_) || (frame.rxId != this->id_)) {
+      return;
+    }
+    switch (frame.command) {
+      case FAN_TYPE_QUERY_DEVICE:
+      case FAN_FRAME_SETSPEED:
+        // Repeated frames arrive back to back; answer once per request
+        if ((this->sim_->now() - this->lastReply_) > 100000ULL) {
+          const SimFrame reply = this->frameTo(frame.txType, frame.txId, FAN_TYPE_FAN_SETTINGS);
+
+          this->lastReply_ = this->sim_->now();
+          this->sim_->after(MAIN_UNIT_RESPONSE_US, [this, reply]() { this->send(reply, FAN_TX_FRAMES); });
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+
+ protected:
+  SimTime lastReply_{0};
+};
+
+// Wall remote or CO2 sensor: sends a burst at random intervals, does not listen before talking
+class Sender : public Node {
+ public:
+  Sender(Simulator *const pSim, Channel *const pChannel, const uint32_t network, const uint8_t type, const uint8_t id,
+         const uint8_t mainId, const uint8_t command, const double interval, Stats *const pStats)
+      : Node(pSim, pChannel, network, type, id),
+        mainId_(mainId),
+        command_(command),
+        interval_(interval),
+        stats_(pStats) {}
+
+  void start(void) override { this->schedule(); }
+
+  void receive(const SimFrame &frame) override {
+    if (this->waiting_ && (frame.rxType == this->type_) && (frame.rxId == this->id_) &&
+        (frame.command == FAN_TYPE_FAN_SETTINGS)) {
+      this->waiting_ = false;
+      this->stats_->add(true, this->sim_->now() - this->sentTime_, 1);
+    }
+  }
+
+ protected:
+  void schedule(void) {
+    this->sim_->after(this->sim_->exponential(this->interval_), [this]() {
+      if (this->waiting_) {
+        this->stats_->add(false, 0, 1);
+      }
+      this->waiting_ = (this->command_ == FAN_FRAME_SETSPEED);
+      this->sentTime_ = this->sim_->now();
+      this->send(this->frameTo(FAN_TYPE_MAIN_UNIT, this->mainId_, this->command_), FAN_TX_FRAMES);
+      this->schedule();
+    });
+  }
+
+  uint8_t mainId_;
+  uint8_t command_;
+  double interval_;
+  Stats *stats_;
+  bool waiting_{false};
+  SimTime sentTime_{0};
+};
+
+// Follows the transmit policy of ZehnderRF::rfHandler
+class Bridge : public Node {
+ public:
+  Bridge(Simulator *const pSim, Channel *const pChannel, const uint32_t network, const uint8_t id,
+         const uint8_t mainId, const BridgePolicy &policy, Stats *const pPolls, Stats *const pCommands)
+      : Node(pSim, pChannel, network, FAN_TYPE_REMOTE_CONTROL, id),
+        mainId_(mainId),
+        policy_(policy),
+        polls_(pPolls),
+        commands_(pCommands) {
+    this->rxDedup_.set_window(RX_DEDUP_WINDOW);
+    this->publish_.set_min_interval(PUBLISH_MIN_INTERVAL);
+    this->publish_.set_heartbeat(PUBLISH_HEARTBEAT);
+  }
+
+  void start(void) override {
+    // Random phase, bridges boot at different times
+    this->lastQuery_ = this->sim_->clock()->millis() - (uint32_t) (this->sim_->uniform() * this->pollIntervalMs());
+    this->sim_->after(POLL_CHECK_US, [this]() { this->poll(); });
+    if (this->policy_.commandInterval > 0) {
+      this->scheduleCommand();
+    }
+  }
+
+  void receive(const SimFrame &frame) override {
+    const uint8_t bytes[] = {frame.rxType, frame.rxId, frame.txType, frame.txId, frame.command};
+
+    if (this->rxDedup_.isDuplicate(bytes, sizeof(bytes), this->sim_->clock()->millis()) == true) {
+      return;
+    }
+    if (!this->waitReply_ || (frame.rxType != this->type_) || (frame.rxId != this->id_) ||
+        (frame.command != FAN_TYPE_FAN_SETTINGS)) {
+      return;
+    }
+
+    this->waitReply_ = false;
+    ++this->generation_;  // Cancel reply timeout
+    this->finish(true);
+  }
+
+  SimTime maxPollGap(void) const { return std::max(this->maxPollGap_, this->sim_->now() - this->lastPollOk_); }
+  uint64_t early{0};  // Deadlines that passed before their period
+
+  SimTime maxPublishGap(void) const {
+    return std::max(this->maxPublishGap_, this->sim_->now() - this->lastPublish_);
+  }
+
+ protected:
+  typedef struct {
+    uint8_t command;
+    SimTime queued;
+  } Request;
+
+  uint32_t pollIntervalMs(void) const { return (uint32_t) (this->policy_.pollInterval / 1000); }
+
+  // Same checks as ZehnderRF::radioStep and radioIdleTime; sleep until due, then wake on a loop iteration
+  void poll(void) {
+    const uint32_t now = this->sim_->clock()->millis();
+    SimTime next = POLL_CHECK_US;
+
+    if (deadlinePassed(now, this->lastQuery_, this->pollIntervalMs()) == true) {
+      this->checkEarly(this->queryTime_, this->policy_.pollInterval);
+      this->queryTime_ = this->sim_->now();
+      this->lastQuery_ = now;
+      this->enqueue(FAN_TYPE_QUERY_DEVICE);
+    } else {
+      next = std::min<SimTime>(
+          next, (SimTime) deadlineRemaining(now, this->lastQuery_, this->pollIntervalMs()) * 1000ULL);
+    }
+
+    // Held back changes and heartbeats, as ZehnderRF::publishDue
+    if (this->publish_.due(now) == true) {
+      this->published();
+    }
+
+    this->sim_->after(next + this->loopJitter(), [this]() { this->poll(); });
+  }
+
+  // A deadline that passes before its period is as wrong as one that never passes
+  void checkEarly(const SimTime since, const SimTime period) {
+    if ((since > 0) && ((this->sim_->now() - since) < period)) {
+      ++this->early;
+    }
+  }
+
+  void published(void) {
+    this->maxPublishGap_ = std::max(this->maxPublishGap_, this->sim_->now() - this->lastPublish_);
+    this->lastPublish_ = this->sim_->now();
+  }
+
+  SimTime loopJitter(void) { return (SimTime) (this->sim_->uniform() * LOOP_PERIOD_US); }
+
+  void scheduleCommand(void) {
+    this->sim_->after(this->sim_->exponential(this->policy_.commandInterval), [this]() {
+      this->enqueue(FAN_FRAME_SETSPEED);
+      this->scheduleCommand();
+    });
+  }
+
+  void enqueue(const uint8_t command) {
+    this->queue_.push_back(Request{command, this->sim_->now()});
+    if (this->queue_.size() == 1) {
+      this->begin();
+    }
+  }
+
+  void begin(void) {
+    this->attempts_ = 0;
+    this->attempt();
+  }
+
+  void attempt(void) {
+    this->airwayWait_ = this->sim_->clock()->millis();
+    ++this->attempts_;
+    this->waitAirway();
+  }
+
+  void waitAirway(void) {
+    if (this->policy_.carrierSense && this->channel_->busy()) {
+      if (deadlinePassed(this->sim_->clock()->millis(), this->airwayWait_, AIRWAY_GIVE_UP_MS) == true) {
+        this->finish(false);
+      } else {
+        this->sim_->after(LOOP_PERIOD_US, [this]() { this->waitAirway(); });
+      }
+      return;
+    }
+
+    // One frame per attempt; auto retransmit is off in nRF905::startTx
+    this->send(this->frameTo(FAN_TYPE_MAIN_UNIT, this->mainId_, this->queue_.front().command), 1);
+    this->waitReply_ = true;
+
+    // The timeout is noticed on the next loop iteration after it passed
+    this->msgSendTime_ = this->sim_->clock()->millis();
+    this->sendTime_ = this->sim_->now();
+    this->replyTimeoutMs_ = (uint32_t) (this->replyTimeout() / 1000);
+    this->waitTimeout(++this->generation_);
+  }
+
+  void waitTimeout(const uint64_t generation) {
+    const uint32_t remaining =
+        deadlineRemaining(this->sim_->clock()->millis(), this->msgSendTime_, this->replyTimeoutMs_);
+
+    this->sim_->after((SimTime) remaining * 1000ULL + this->loopJitter(), [this, generation]() {
+      if (generation != this->generation_) {
+        return;
+      }
+      if (deadlinePassed(this->sim_->clock()->millis(), this->msgSendTime_, this->replyTimeoutMs_) == true) {
+        this->checkEarly(this->sendTime_, (SimTime) this->replyTimeoutMs_ * 1000ULL);
+        this->timeout();
+      } else {
+        this->waitTimeout(generation);
+      }
+    });
+  }
+
+  SimTime replyTimeout(void) {
+    SimTime timeout = this->policy_.replyTimeout;
+
+    if (this->policy_.backoff) {
+      // Exponential backoff with full jitter on top of the reply window
+      const unsigned shift = std::min(this->attempts_ - 1, 4U);
+      timeout += (SimTime) (this->sim_->uniform() * (this->policy_.replyTimeout << shift) / 2);
+    }
+    return timeout;
+  }
+
+  void timeout(void) {
+    this->waitReply_ = false;
+    if (this->attempts_ <= this->policy_.retries) {
+      this->attempt();
+    } else {
+      this->finish(false);
+    }
+  }
+
+  void finish(const bool delivered) {
+    const Request request = this->queue_.front();
+    Stats *const pStats = (request.command == FAN_TYPE_QUERY_DEVICE) ? this->polls_ : this->commands_;
+
+    pStats->add(delivered, this->sim_->now() - request.queued, this->attempts_);
+    if (delivered && (request.command == FAN_TYPE_QUERY_DEVICE)) {
+      this->maxPollGap_ = std::max(this->maxPollGap_, this->sim_->now() - this->lastPollOk_);
+      this->lastPollOk_ = this->sim_->now();
+    }
+    if (delivered && (request.command == FAN_FRAME_SETSPEED)) {
+      this->send(this->frameTo(FAN_TYPE_MAIN_UNIT, this->mainId_, FAN_FRAME_SETSPEED_REPLY), 1);
+      ++this->speed_;
+    }
+    if (delivered && (this->publish_.offer(this->speed_ % 5, this->sim_->clock()->millis()) == true)) {
+      this->published();
+    }
+
+    this->queue_.erase(this->queue_.begin());
+    if (!this->queue_.empty()) {
+      // Next request on the next loop
+      this->sim_->after(LOOP_PERIOD_US, [this]() { this->begin(); });
+    }
+  }
+
+  uint8_t mainId_;
+  BridgePolicy policy_;
+  Stats *polls_;
+  Stats *commands_;
+
+  std::vector<Request> queue_;
+  unsigned attempts_{0};
+  uint32_t lastQuery_{0};
+  uint32_t airwayWait_{0};
+  SimTime lastPollOk_{0};
+  SimTime maxPollGap_{0};
+  bool waitReply_{false};
+  uint64_t generation_{0};
+  uint32_t msgSendTime_{0};
+  SimTime sendTime_{0};
+  SimTime queryTime_{0};
+  uint32_t replyTimeoutMs_{0};
+
+  esphome::nrf905::RxDedup rxDedup_;
+  esphome::zehnder::PublishLimiter publish_;
+  unsigned speed_{0};
+  SimTime lastPublish_{0};
+  SimTime maxPublishGap_{0};
+};
+
+static void usage(const char *const name) {
+  printf("Usage: %s [options]\n"
+         "  --units N        Networks (main units) on the channel (default 4)\n"
+         "  --bridges N      Bridges per network (default 1)\n"
+         "  --remotes N      Wall remotes per network (default 1)\n"
+         "  --co2 N          CO2 sensors per network (default 0)\n"
+         "  --hours H        Simulated time (default 24)\n"
+         "  --per P          Packet error rate per link (default 0.02)\n"
+         "  --poll S         Bridge polling interval in seconds (default 60)\n"
+         "  --commands S     Mean seconds between bridge speed commands, 0 = none (default 600)\n"
+         "  --timeout MS     Reply timeout (default %u)\n"
+         "  --retries N      Retries (default %u)\n"
+         "  --policy P       fixed | backoff (default fixed)\n"
+         "  --no-cs          Do not wait for a free airway\n"
+         "  --start-ms N     Initial millis() value (default 0)\n"
+         "  --soak           60 days starting one hour before the millis() wraparound\n"
+         "  --seed N         Random seed (default 1)\n",
+         name, FAN_REPLY_TIMEOUT, FAN_TX_RETRIES);
+}
+
+int main(int argc, char **argv) {
+  unsigned units = 4, bridges = 1, remotes = 1, co2 = 0, seed = 1;
+  uint32_t startMs = 0;
+  double hours = 24, per = 0.02, poll = 60, commands = 600;
+  BridgePolicy policy = {FAN_REPLY_TIMEOUT * 1000ULL, FAN_TX_RETRIES, false, true, 0, 0};
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const char *const value = (i + 1 < argc) ? argv[i + 1] : "";
+
+    if (arg == "--units") {
+      units = atoi(value), ++i;
+    } else if (arg == "--bridges") {
+      bridges = atoi(value), ++i;
+    } else if (arg == "--remotes") {
+      remotes = atoi(value), ++i;
+    } else if (arg == "--co2") {
+      co2 = atoi(value), ++i;
+    } else if (arg == "--hours") {
+      hours = atof(value), ++i;
+    } else if (arg == "--per") {
+      per = atof(value), ++i;
+    } else if (arg == "--poll") {
+      poll = atof(value), ++i;
+    } else if (arg == "--commands") {
+      commands = atof(value), ++i;
+    } else if (arg == "--timeout") {
+      policy.replyTimeout = atoi(value) * 1000ULL, ++i;
+    } else if (arg == "--retries") {
+      policy.retries = atoi(value), ++i;
+    } else if (arg == "--policy") {
+      policy.backoff = (strcmp(value, "backoff") == 0), ++i;
+    } else if (arg == "--no-cs") {
+      policy.carrierSense = false;
+    } else if (arg == "--start-ms") {
+      startMs = strtoul(value, NULL, 0), ++i;
+    } else if (arg == "--soak") {
+      startMs = UINT32_MAX - 3600000UL;
+      hours = 60 * 24;
+    } else if (arg == "--seed") {
+      seed = atoi(value), ++i;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  policy.pollInterval = (SimTime) (poll * 1e6);
+  policy.commandInterval = commands * 1e6;
+
+  Simulator sim(seed, startMs);
+  Channel channel(&sim, per);
+  Stats polls, bridgeCommands, remoteCommands;
+  std::vector<std::unique_ptr<Node>> nodes;
+
+  for (unsigned unit = 0; unit < units; ++unit) {
+    const uint32_t network = 0x10000000 + unit;
+    const uint8_t mainId = 0x10 + unit;
+    uint8_t id = 0x40;
+
+    nodes.emplace_back(new MainUnit(&sim, &channel, network, mainId));
+    for (unsigned i = 0; i < bridges; ++i) {
+      nodes.emplace_back(new Bridge(&sim, &channel, network, id++, mainId, policy, &polls, &bridgeCommands));
+    }
+    for (unsigned i = 0; i < remotes; ++i) {
+      nodes.emplace_back(new Sender(&sim, &channel, network, FAN_TYPE_REMOTE_CONTROL, id++, mainId,
+                                    FAN_FRAME_SETSPEED, 3600e6, &remoteCommands));
+    }
+    for (unsigned i = 0; i < co2; ++i) {
+      nodes.emplace_back(
+          new Sender(&sim, &channel, network, FAN_TYPE_CO2_SENSOR, id++, mainId, FAN_FRAME_CO2, 60e6, NULL));
+    }
+  }
+  for (const std::unique_ptr<Node> &pNode : nodes) {
+    pNode->start();
+  }
+
+  const SimTime end = (SimTime) (hours * 3600e6);
+  const auto wallStart = std::chrono::steady_clock::now();
+  sim.run(end);
+  const double wall =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+  SimTime airtime[3] = {0, 0, 0};
+  SimTime maxPollGap = 0;
+  SimTime maxPublishGap = 0;
+  unsigned stuck = 0;
+  unsigned silent = 0;
+  uint64_t early = 0;
+  for (const std::unique_ptr<Node> &pNode : nodes) {
+    const Bridge *const pBridge = dynamic_cast<Bridge *>(pNode.get());
+    const int index = (pNode->type() == FAN_TYPE_MAIN_UNIT) ? 0 : ((pBridge != NULL) ? 1 : 2);
+
+    airtime[index] += pNode->airtime;
+    if (pBridge != NULL) {
+      maxPollGap = std::max(maxPollGap, pBridge->maxPollGap());
+      stuck += (pBridge->maxPollGap() > 10 * policy.pollInterval) ? 1 : 0;
+      // A heartbeat is due every PUBLISH_HEARTBEAT; allow for the check period and loop jitter
+      maxPublishGap = std::max(maxPublishGap, pBridge->maxPublishGap());
+      early += pBridge->early;
+      silent += (pBridge->maxPublishGap() > (PUBLISH_HEARTBEAT * 1000ULL + 2 * POLL_CHECK_US)) ? 1 : 0;
+    }
+  }
+
+  printf("Simulated %.1f h in %.2f s; millis() %u -> %u\n", hours, wall, startMs, sim.clock()->millis());
+  printf("Site: %u networks, %u bridges, %u remotes, %u CO2 sensors each; %.1f h; PER %.3f\n", units, bridges,
+         remotes, co2, hours, per);
+  printf("Policy: timeout %llu ms, retries %u, %s, carrier sense %s, poll %.0f s\n",
+         (unsigned long long) (policy.replyTimeout / 1000), policy.retries, policy.backoff ? "backoff" : "fixed",
+         policy.carrierSense ? "on" : "off", poll);
+  printf("Delivery:\n");
+  polls.print("poll");
+  bridgeCommands.print("command");
+  remoteCommands.print("remote");
+  printf("Channel:\n");
+  printf("  busy %.3f%%  frames %llu  collided %.2f%%  lost %llu\n", 100.0 * channel.busyTime / end,
+         (unsigned long long) channel.frames, channel.frames ? (100.0 * channel.collided / channel.frames) : 0.0,
+         (unsigned long long) channel.lost);
+  printf("  airtime main units %.3f%%  bridges %.3f%%  remotes/sensors %.3f%%\n", 100.0 * airtime[0] / end,
+         100.0 * airtime[1] / end, 100.0 * airtime[2] / end);
+  printf("Bridges:\n");
+  printf("  longest gap between polls %.1f s  stuck %u\n", maxPollGap / 1e6, stuck);
+  printf("  longest gap between fan state publishes %.1f s  silent %u\n", maxPublishGap / 1e6, silent);
+  printf("  polls and reply timeouts before their time %llu\n", (unsigned long long) early);
+
+  return ((stuck > 0) || (silent > 0) || (early > 0)) ? 2 : 0;
+}
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Static footprint of the nrf905 and zehnder components in a firmware image.
+
+Reads the symbol table of the firmware ELF (for example
+.esphome/build/<node>/.pioenvs/<node>/firmware.elf) and sums the symbols of
+the esphome::nrf905 and esphome::zehnder namespaces per section.
+
+    tools/size_report.py firmware.elf --nm xtensa-esp32-elf-nm
+    tools/size_report.py firmware.elf --save size.json
+    tools/size_report.py firmware.elf --baseline size.json --max-growth 64
+
+With --baseline the script exits with status 1 when the RAM use of a
+component grew by more than --max-growth bytes.
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+
+COMPONENTS = {
+    "nrf905": "esphome::nrf905::",
+    "zehnder": "esphome::zehnder::",
+}
+
+# nm symbol types: text and read-only data live in flash, data and bss in RAM
+SECTIONS = {
+    "t": "text",
+    "r": "rodata",
+    "d": "data",
+    "b": "bss",
+}
+
+
+def read_symbols(nm, elf):
+    output = subprocess.run(
+        [nm, "--print-size", "--size-sort", "--demangle", elf],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+
+    for line in output.splitlines():
+        parts = line.split(" ", 3)
+        if len(parts) != 4:
+            continue
+        _, size, kind, name = parts
+        section = SECTIONS.get(kind.lower())
+        if section is not None:
+            yield name, int(size, 16), section
+
+
+def report(nm, elf, top):
+    result = {}
+
+    for component in COMPONENTS:
+        result[component] = {
+            "text": 0,
+            "rodata": 0,
+            "data": 0,
+            "bss": 0,
+            "symbols": [],
+        }
+
+    for name, size, section in read_symbols(nm, elf):
+        for component, prefix in COMPONENTS.items():
+            if prefix in name:
+                result[component][section] += size
+                result[component]["symbols"].append((size, section, name))
+                break
+
+    for component, sizes in result.items():
+        sizes["ram"] = sizes["data"] + sizes["bss"]
+        sizes["flash"] = sizes["text"] + sizes["rodata"] + sizes["data"]
+        sizes["symbols"] = sorted(sizes["symbols"], reverse=True)[:top]
+
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="Firmware ELF file")
+    parser.add_argument("--nm", default="xtensa-esp32-elf-nm", help="nm of the target toolchain")
+    parser.add_argument("--top", type=int, default=10, help="Number of largest symbols to list")
+    parser.add_argument("--save", help="Write the sizes to this JSON file")
+    parser.add_argument("--baseline", help="Compare against sizes saved earlier")
+    parser.add_argument("--max-growth", type=int, default=0, help="Allowed RAM growth in bytes")
+    args = parser.parse_args()
+
+    result = report(args.nm, args.elf, args.top)
+
+    for component, sizes in result.items():
+        print(
+            f"{component}: RAM {sizes['ram']} B (data {sizes['data']}, bss {sizes['bss']}), "
+            f"flash {sizes['flash']} B (text {sizes['text']}, rodata {sizes['rodata']})"
+        )
+        for size, section, name in sizes["symbols"]:
+            print(f"  {size:7d} {section:6s} {name}")
+
+    if args.save:
+        with open(args.save, "w", encoding="utf-8") as file:
+            json.dump({c: {k: v for k, v in s.items() if k != "symbols"} for c, s in result.items()}, file, indent=2)
+
+    status = 0
+    if args.baseline:
+        with open(args.baseline, encoding="utf-8") as file:
+            baseline = json.load(file)
+        for component, sizes in result.items():
+            growth = sizes["ram"] - baseline.get(component, {}).get("ram", 0)
+            if growth > args.max_growth:
+                print(f"{component}: RAM grew by {growth} B (allowed {args.max_growth} B)", file=sys.stderr)
+                status = 1
+
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())